@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Local stand-in for the streamed assistant run endpoint.
+
+Serves POST /v1/threads/runs as chunked server-sent events over a kept
+alive HTTP/1.1 connection, one delta per word. Point the device at it with
+AiManager::setEndpoint("<host ip>", 8080, false).
+
+    ai_stub.py [--port 8080] [--delay 0.1] [--fail]
+"""
+import argparse
+import json
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+import time
+
+REPLY = "Die Kiwi sagt: Heute wird ein guter Tag fuer schoene Builds."
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def chunk(self, text):
+        data = text.encode()
+        self.wfile.write(b"%x\r\n%s\r\n" % (len(data), data))
+        self.wfile.flush()
+
+    def event(self, name, data):
+        self.chunk("event: %s\ndata: %s\n\n" % (name, data))
+
+    def do_POST(self):
+        request = json.loads(self.rfile.read(int(self.headers["Content-Length"])))
+        prompt = request["thread"]["messages"][0]["content"]
+        print("prompt:", prompt, "stream:", request.get("stream"))
+
+        self.send_response(200)
+        self.send_header("Content-Type", "text/event-stream")
+        self.send_header("Transfer-Encoding", "chunked")
+        self.end_headers()
+
+        self.event("thread.run.created", json.dumps({"id": "run_stub", "status": "queued"}))
+        for i, word in enumerate(REPLY.split(" ")):
+            time.sleep(args.delay)
+            value = word if i == 0 else " " + word
+            delta = {"id": "msg_stub", "object": "thread.message.delta",
+                     "delta": {"content": [{"index": 0, "type": "text", "text": {"value": value}}]}}
+            self.event("thread.message.delta", json.dumps(delta))
+        self.event("thread.run.failed" if args.fail else "thread.run.completed", "{}")
+        self.event("done", "[DONE]")
+        self.wfile.write(b"0\r\n\r\n")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--delay", type=float, default=0.1)
+    parser.add_argument("--fail", action="store_true")
+    args = parser.parse_args()
+    ThreadingHTTPServer(("", args.port), Handler).serve_forever()
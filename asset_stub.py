@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Local stand-in for the asset host (raw.githubusercontent.com).
+
+Serves a directory over HTTP/1.1 with keep-alive, strong ETags,
+If-None-Match (304), Range with If-Range (206, 416) and optionally cuts the
+first response for each file short, so FileDownloader's resume, revalidation
+and rename paths can be exercised. Build the device against it with
+
+    build_flags = -DASSET_BASE_URL='"http://<host ip>:8000"'
+
+    asset_stub.py [--port 8000] [--dir assets] [--truncate 0.5] [--rate 20000]
+
+With --truncate the first sync keeps "<file>.tmp" files, the next one
+resumes them with Range requests; a sync after that gets only 304s.
+"""
+import argparse
+import hashlib
+import os
+import re
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+truncated = set()
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def send_empty(self, status, headers=()):
+        self.send_response(status)
+        for name, value in headers:
+            self.send_header(name, value)
+        self.send_header("Content-Length", "0")
+        self.end_headers()
+
+    def do_GET(self):
+        path = os.path.join(args.dir, os.path.basename(self.path.split("?")[0]))
+        if not os.path.isfile(path):
+            self.send_empty(404)
+            return
+        with open(path, "rb") as f:
+            data = f.read()
+        etag = '"%s"' % hashlib.sha1(data).hexdigest()[:16]
+
+        if self.headers.get("If-None-Match") == etag:
+            print("304", path)
+            self.send_empty(304, [("ETag", etag)])
+            return
+
+        start = 0
+        status = 200
+        match = re.match(r"bytes=(\d+)-$", self.headers.get("Range", ""))
+        if match and self.headers.get("If-Range", etag) == etag:
+            start = int(match.group(1))
+            if start >= len(data):
+                print("416", path, start)
+                self.send_empty(416, [("ETag", etag), ("Content-Range", "bytes */%d" % len(data))])
+                return
+            status = 206
+
+        body = data[start:]
+        self.send_response(status)
+        self.send_header("ETag", etag)
+        self.send_header("Content-Length", str(len(body)))
+        if status == 206:
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (start, len(data) - 1, len(data)))
+        self.end_headers()
+
+        # Cut the first response for each file short and drop the connection
+        limit = len(body)
+        if args.truncate and path not in truncated:
+            truncated.add(path)
+            limit = int(len(body) * args.truncate)
+            self.close_connection = True
+        print(status, path, "bytes %d-%d of %d" % (start, start + limit, len(data)))
+
+        for offset in range(0, limit, 1024):
+            self.wfile.write(body[offset:min(offset + 1024, limit)])
+            if args.rate:
+                time.sleep(1024 / args.rate)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=8000)
+    parser.add_argument("--dir", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "assets"))
+    parser.add_argument("--truncate", type=float, default=0, help="fraction of the first response to send")
+    parser.add_argument("--rate", type=int, default=0, help="bytes per second, 0 for unlimited")
+    args = parser.parse_args()
+    ThreadingHTTPServer(("", args.port), Handler).serve_forever()
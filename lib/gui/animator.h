@@ -1,4 +1,5 @@
 #include <Ticker.h>
+#include <Schedule.h>
 #include <Arduino.h>
 #include <gui.h>
 #include <functional>
@@ -74,8 +75,8 @@ private:
     Ticker _delayedCallbackTicker; // New ticker for delayed callback execution
     String _text;
     uint8_t _frame = 210;
-    uint8_t _index = 0;
-    uint8_t _length = 0;
+    uint16_t _index = 0;
+    uint16_t _length = 0;
     uint8_t _cycles = 1;
     uint8_t _currentCycle = 1;
     uint8_t _positions = 0;
@@ -87,7 +88,15 @@ private:
     bool _running = false;
     void (*_globalEndCallback)() = nullptr;   // Global callback for all animations
     void (*_startCallback)() = nullptr;
-    std::function<void()> _animCallback = nullptr;
+    void (Animator::*_animCallback)() = nullptr; // Member pointer, binding it would allocate
+
+    // Scroll text as borrowed segments: intro, a 6 space gap, then body.
+    // The caller keeps both buffers alive while the animation runs.
+    const char *_intro = nullptr;
+    const char *_body = nullptr;
+    uint16_t _introLength = 0;
+    uint16_t _bodyLength = 0;
+    bool _streaming = false; // Intro is still growing, wait at its end
     
     // New: Animation-specific callback
     std::function<void()> _currentAnimEndCallback = nullptr;
@@ -97,6 +106,30 @@ private:
         instance->loop();
     }
 
+    // Runs in timer context and hands the frame over to the main loop.
+    // The capture fits std::function's inline storage, so no allocation.
+    static void _static_tick(Animator *instance)
+    {
+        schedule_function([instance]() { _static_callback(instance); });
+    }
+
+    // Character at a position of the scroll text, '\0' past the end
+    char text_char_at(uint16_t pos) const
+    {
+        if (pos < 5)
+            return ' '; // Lead-in so the text enters from the right
+        pos -= 5;
+        if (pos < _introLength)
+            return _intro[pos];
+        pos -= _introLength;
+        if (!_body)
+            return '\0';
+        if (pos < 6)
+            return ' ';
+        pos -= 6;
+        return pos < _bodyLength ? _body[pos] : '\0';
+    }
+
     // Helper method to execute a delayed callback
     void executeDelayedCallback(std::function<void()> callback, unsigned long delayMs)
     {
@@ -109,7 +142,16 @@ private:
 
     void text_callback()
     {
-        vfd_gui_set_text(_text.substring(_index, _index + 6).c_str());
+        char window[7];
+        uint8_t i = 0;
+        for (; i < 6; i++)
+        {
+            window[i] = text_char_at(_index + i);
+            if (window[i] == '\0')
+                break;
+        }
+        window[i] = '\0';
+        vfd_gui_set_text(window);
     }
 
     void loading_callback()
@@ -411,7 +453,7 @@ void start(uint8_t cycles = 1, std::function<void()> callback = nullptr, unsigne
     if (_startCallback)
         _startCallback();
         
-    _ticker.attach_ms_scheduled_accurate(_frame, std::bind(&Animator::_static_callback, this));
+    _ticker.attach_ms(_frame, _static_tick, this);
 }
 
 public:
@@ -436,18 +478,65 @@ public:
         _length = SEGMENT_STEPS_COUNT - 1;
         _frame = 80;
         _positions = positions;
-        _animCallback = std::bind(&Animator::loading_callback, this);
+        _animCallback = &Animator::loading_callback;
         _animType = ANIM_LOADING;
         start(255, callback, delayMs);
     }
 
+    // Scroll an intro and a body without joining them into one string.
+    // Both pointers are borrowed and must stay valid until the end.
+    void set_segments_and_run(const char *intro, const char *body, uint8_t frame = 210, uint8_t cycles = 1,
+                              std::function<void()> callback = nullptr, unsigned long delayMs = 0)
+    {
+        if (_running)
+            stop();
+
+        set_segments(intro, body, frame);
+        start(cycles, callback, delayMs);
+    }
+
+    // Scroll a text that is still arriving. `text` is borrowed and may only
+    // grow in place: call stream_append() after adding to it and
+    // stream_end() once it is complete. Until then the scroll waits at the
+    // end of what has arrived instead of finishing.
+    void start_stream(const char *text, uint8_t frame = 210, std::function<void()> callback = nullptr)
+    {
+        if (_running)
+            stop();
+
+        set_segments(text, nullptr, frame);
+        _streaming = true;
+        start(1, callback);
+    }
+
+    void stream_append()
+    {
+        _introLength = strlen(_intro);
+        _length = 5 + _introLength;
+    }
+
+    void stream_end()
+    {
+        stream_append();
+        _streaming = false;
+    }
+
     void set_text(const char *text, uint8_t frame = 210)
     {
-        _text = "     ";
-        _text += text;
+        // Keep our own copy, callers often pass stack buffers
+        _text = text;
+        set_segments(_text.c_str(), nullptr, frame);
+    }
+
+    void set_segments(const char *intro, const char *body, uint8_t frame = 210)
+    {
+        _intro = intro;
+        _introLength = strlen(intro);
+        _body = body;
+        _bodyLength = body ? strlen(body) : 0;
         _frame = frame;
-        _length = _text.length();
-        _animCallback = std::bind(&Animator::text_callback, this);
+        _length = 5 + _introLength + (body ? 6 + _bodyLength : 0);
+        _animCallback = &Animator::text_callback;
         _animType = ANIM_TEXT;
     }
 
@@ -461,7 +550,7 @@ public:
         _frame = frame;
         _index = 0;
         _length = FADE_SEGMENTS_COUNT - 1;
-        _animCallback = std::bind(&Animator::fade_in_callback, this);
+        _animCallback = &Animator::fade_in_callback;
         _animType = ANIM_FADE_IN;
         start(1, callback, delayMs); // Run through the fade sequence once
     }
@@ -477,7 +566,7 @@ public:
         _frame = frame;
         _index = FADE_SEGMENTS_COUNT - 1; // Start from full visibility
         _length = 0;                      // End at 0 visibility
-        _animCallback = std::bind(&Animator::fade_out_callback, this);
+        _animCallback = &Animator::fade_out_callback;
         _animType = ANIM_FADE_OUT;
         start(1, callback, delayMs); // Run through the fade sequence once
     }
@@ -508,7 +597,7 @@ public:
         // For most characters there are about 21 segments
         _index = 0;
         _length = 20; // Maximum number of segments per character
-        _animCallback = std::bind(&Animator::advanced_fade_in_callback, this);
+        _animCallback = &Animator::advanced_fade_in_callback;
         _animType = ANIM_ADVANCED_FADE_IN;
         start(1, callback, delayMs);
     }
@@ -537,7 +626,7 @@ public:
         _frame = frame;
         _index = 0;
         _length = 20; // Maximum number of segments per character
-        _animCallback = std::bind(&Animator::advanced_fade_out_callback, this);
+        _animCallback = &Animator::advanced_fade_out_callback;
         _animType = ANIM_ADVANCED_FADE_OUT;
         start(1, callback, delayMs);
     }
@@ -566,7 +655,7 @@ public:
 
         _index = 0;
         _length = 10; // 10 steps for random fade
-        _animCallback = std::bind(&Animator::random_fade_in_callback, this);
+        _animCallback = &Animator::random_fade_in_callback;
         _animType = ANIM_RANDOM_FADE_IN;
         start(1, callback, delayMs);
     }
@@ -595,7 +684,7 @@ public:
 
         _index = 0;
         _length = 10; // 10 steps for random fade
-        _animCallback = std::bind(&Animator::random_fade_out_callback, this);
+        _animCallback = &Animator::random_fade_out_callback;
         _animType = ANIM_RANDOM_FADE_OUT;
         start(1, callback, delayMs);
     }
@@ -620,7 +709,7 @@ public:
 
         _index = 0;
         _length = _text.length() - 6; // Length minus display width
-        _animCallback = std::bind(&Animator::wave_effect_callback, this);
+        _animCallback = &Animator::wave_effect_callback;
         _animType = ANIM_WAVE;
         start(1, callback, delayMs);
     }
@@ -640,7 +729,7 @@ public:
 
         _index = 0;
         _length = strlen(text);
-        _animCallback = std::bind(&Animator::typewriter_effect_callback, this);
+        _animCallback = &Animator::typewriter_effect_callback;
         _animType = ANIM_TYPEWRITER;
         start(1, callback, delayMs);
     }
@@ -659,7 +748,7 @@ public:
 
         _index = 0;
         _length = 6; // 6 steps for the 6 characters
-        _animCallback = std::bind(&Animator::reveal_effect_callback, this);
+        _animCallback = &Animator::reveal_effect_callback;
         _animType = ANIM_REVEAL;
         start(1, callback, delayMs);
     }
@@ -667,6 +756,7 @@ public:
     void stop()
     {
         _running = false;
+        _streaming = false;
         _ticker.detach();
         _delayedCallbackTicker.detach(); // Ensure any pending delayed callbacks are cancelled
         
@@ -697,11 +787,18 @@ public:
     {
         if (_running)
         {
+            // A streamed text shows its last characters until more arrive
+            if (_streaming && _index + 6 > _length)
+            {
+                return;
+            }
+
             // Handle animations that go forward (index increases)
             if ((_animType == ANIM_TEXT ||
                  _animType == ANIM_LOADING ||
                  _animType == ANIM_FADE_IN ||
                  _animType == ANIM_ADVANCED_FADE_IN ||
+                 _animType == ANIM_ADVANCED_FADE_OUT ||
                  _animType == ANIM_RANDOM_FADE_IN ||
                  _animType == ANIM_RANDOM_FADE_OUT || 
                  _animType == ANIM_WAVE ||
@@ -717,19 +814,20 @@ public:
                 }
                 _index = 0;
             }
-            // Handle animations that go backward (index decreases)
-            else if (_animType == ANIM_FADE_OUT && _index < _length)
-            {
-                stop();
-                return;
-            }
 
             // Call the animation callback
-            _animCallback();
+            (this->*_animCallback)();
 
             // Update the index based on animation direction
             if (_animType == ANIM_FADE_OUT)
             {
+                // Animations that go backward end after their last step;
+                // decrementing past zero would wrap the unsigned index
+                if (_index <= _length)
+                {
+                    stop();
+                    return;
+                }
                 _index--;
             }
             else
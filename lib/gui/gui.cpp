@@ -24,6 +24,7 @@
 
 u8 lightOff = 1;   // Backlight switch
 u8 lightLevel = 2; // Brightness level
+u8 filamentDuty = FILAMENT_DUTY; // Filament PWM duty
 
 u8 mh1, mh2; // Colon 1, 2
 
@@ -42,7 +43,7 @@ void vfd_gui_init()
     // ------------------------------------
     // Frequency used for V2V3 version
     analogWriteFreq(20000);
-    analogWrite(PWM_PIN, 25);
+    analogWrite(PWM_PIN, filamentDuty);
     // ------------------------------------
     // Frequency for V1
     //  analogWriteFreq(20000);
@@ -65,10 +66,10 @@ void vfd_gui_stop()
 void vfd_gui_clear()
 {
     setModeWirteDisplayMode(0); // command2
-    u8 clearBuf[24];
+    u8 clearBuf[VFD_FRAME_LEN];
     memset(clearBuf, 0x00, sizeof(clearBuf));
     setModeWirteDisplayMode(0);              // command2
-    sendDigAndData(0, clearBuf, 24);         // command3
+    sendDigAndData(0, clearBuf, VFD_FRAME_LEN); // command3
     ptSetDisplayLight(lightOff, lightLevel); // command4
 }
 
@@ -95,6 +96,19 @@ void vfd_gui_set_one_pattern(size_t index, u32 pattern)
     ptSetDisplayLight(lightOff, lightLevel); // command4
 }
 
+void vfd_gui_write_frame(const u8 *data, size_t len)
+{
+    if (len > VFD_FRAME_LEN)
+    {
+        len = VFD_FRAME_LEN;
+    }
+    setModeWirteDisplayMode(0);              // command2
+    sendDigAndData(0, data, len);            // command3
+    ptSetDisplayLight(lightOff, lightLevel); // command4
+    // The frame replaced the icon grid, the next vfd_gui_set_icon must write
+    current_icon_flag = ~0u;
+}
+
 void vfd_gui_set_icon(u32 buf, u8 is_save_state)
 {
     if (current_icon_flag == buf)
@@ -195,6 +209,12 @@ void vfd_gui_set_blk_level(size_t level)
     lightLevel = level;
 }
 
+void vfd_gui_set_filament(u8 duty)
+{
+    filamentDuty = duty;
+    analogWrite(PWM_PIN, filamentDuty);
+}
+
 static void vfd_set_maohao(u8 address, u8 buf)
 {
     setModeWirteDisplayMode(1);              // command2
@@ -74,9 +74,15 @@
 // VFD digit length
 #define VFD_DIG_LEN 6
 
+// Display RAM written by vfd_gui_clear and vfd_gui_write_frame
+#define VFD_FRAME_LEN 24
+
 // Filament PWM pin
 #define PWM_PIN 13
 
+// Filament PWM duty (0-255) set by vfd_gui_init, V2V3 boards
+#define FILAMENT_DUTY 25
+
 /**
  * Initialize
  */
@@ -105,6 +111,17 @@ void vfd_gui_set_one_pattern(size_t index, u32 pattern);
  */
 u8 vfd_gui_set_text(const char *string);
 
+/**
+ * Write raw display RAM from address 0, 3 bytes per grid: six digits,
+ * then the icons. Up to VFD_FRAME_LEN bytes.
+ */
+void vfd_gui_write_frame(const u8 *data, size_t len);
+
+/**
+ * Redraw the pictures set with vfd_gui_set_pic, after a raw frame
+ */
+void vfd_gui_draw_pic();
+
 /**
  * Light up the ICON icon, pass macro definition as parameter
  * @param is_save_state Whether to save this ICON icon to a variable
@@ -133,6 +150,11 @@ void vfd_gui_set_bck(u8 onOff);
  */
 void vfd_gui_set_blk_level(size_t level);
 
+/**
+ * Set the filament PWM duty (0-255), lower runs the filament cooler and dimmer
+ */
+void vfd_gui_set_filament(u8 duty);
+
 /**
  * First colon, parameter bool type
  */
@@ -1,10 +1,16 @@
 #include "kiwi.h"
 #include "base64.hpp"    // Include your custom base64 utilities
-#include <ArduinoJson.h> // Include ArduinoJson library
+#include <recordstore.h>
+
+// 32-bit FNV-1a, shared with the server side of the incremental sync
+#define FNV_OFFSET_BASIS 2166136261UL
+#define FNV_PRIME 16777619UL
 
 Kiwi::Kiwi() : workingBuffer(NULL),
                workingBufferPos(0),
                segmentCount(0),
+               syncedSegmentCount(0),
+               contentHash(FNV_OFFSET_BASIS),
                totalBytesWritten(0)
 {
 }
@@ -45,20 +51,16 @@ bool Kiwi::begin()
     return false;
   }
 
-  // Open the output file
-  if (!openOutputFile())
-  {
-    return false;
-  }
-
+  loadSyncState();
   return true;
 }
 
 bool Kiwi::openOutputFile()
 {
+  // The text file only stages the segments of one response, they are
+  // moved into the record store afterwards
   // Open file for writing (will create or truncate existing file)
-  outputFile = LittleFS.open(outputFilename, "w");
-  if (!outputFile)
+  if (!outputFile.open(outputFilename, "w"))
   {
     Serial.printf("Failed to open output file %s for writing\n", outputFilename);
     return false;
@@ -74,113 +76,171 @@ void Kiwi::closeOutputFile()
   {
     outputFile.close();
     Serial.printf("Closed output file: %s\n", outputFilename);
-
-    // Save metadata after closing the file
-    updateJsonFile(segmentCount);
   }
 }
 
-// Method to load metadata (segment count) from JSON file
-void Kiwi::loadMetadata()
+// Load the sync state, falling back to a full rebuild when it does not
+// match the record store
+void Kiwi::loadSyncState()
 {
-  // Check if JSON file exists
-  if (!LittleFS.exists(jsonFilename))
+  syncedSegmentCount = 0;
+  contentHash = FNV_OFFSET_BASIS;
+
+  File syncFile = LittleFS.open(syncFilename, "r");
+  if (!syncFile)
   {
-    Serial.printf("JSON file %s not found, using current segment count: %d\n", 
-                 jsonFilename, segmentCount);
     return;
   }
-  
-  // Open JSON file for reading
-  File jsonFile = LittleFS.open(jsonFilename, "r");
-  if (!jsonFile)
+  uint16_t count = syncFile.readStringUntil('\n').toInt();
+  uint32_t hash = strtoul(syncFile.readStringUntil('\n').c_str(), NULL, 16);
+  syncFile.close();
+
+  RecordStore store;
+  if (!store.open(RecordStore::storeNameFor(outputFilename).c_str()) || store.count() != count)
   {
-    Serial.printf("Failed to open JSON file %s for reading\n", jsonFilename);
+    Serial.println("Kiwi sync state does not match the store, rebuilding");
     return;
   }
-  
-  // Read the entire file into a string
-  String jsonString = jsonFile.readString();
-  jsonFile.close();
-
-  JsonDocument doc;
-  // Parse the JSON string
-  DeserializationError error = deserializeJson(doc, jsonString);
-  if (error)
+
+  syncedSegmentCount = count;
+  contentHash = hash;
+}
+
+// Sync state layout: first line segment count, second line hash in hex
+void Kiwi::saveSyncState()
+{
+  File syncFile = LittleFS.open(syncFilename, "w");
+  if (!syncFile)
   {
-    Serial.printf("Failed to parse JSON: %s\n", error.c_str());
+    Serial.printf("Failed to write %s\n", syncFilename);
     return;
   }
-  
-  // Find the "kiwi" entry and get its "numrec" value
-  bool kiwiFound = false;
-  for (JsonVariant item : doc.as<JsonArray>())
-  {
-    if (item["menu"] == "kiwi")
-    {
-      segmentCount = item["numrec"];
-      kiwiFound = true;
-      Serial.printf("Loaded segment count from JSON: %d segments\n", segmentCount);
-      break;
-    }
-  }
-  
-  if (!kiwiFound)
+  syncFile.printf("%u\n%08lx\n", syncedSegmentCount, (unsigned long)contentHash);
+  syncFile.close();
+}
+
+void Kiwi::hashSegment(const uint8_t *data, size_t length)
+{
+  for (size_t i = 0; i < length; i++)
   {
-    Serial.println("Warning: 'kiwi' entry not found in JSON");
+    contentHash = (contentHash ^ data[i]) * FNV_PRIME;
   }
+  contentHash = (contentHash ^ '\n') * FNV_PRIME;
 }
 
 bool Kiwi::processApiData()
 {
-  this->begin();
-  WiFiClientSecure client;
+  if (!this->begin())
+  {
+    return false;
+  }
+  FileSink::resetStats();
   HTTPClient http;
 
-  // Skip SSL certificate verification
-  client.setInsecure();
+  // Ask only for the segments after the ones we already have
+  char hashHex[9];
+  snprintf(hashHex, sizeof(hashHex), "%08lx", (unsigned long)contentHash);
+  String url = String(KIWI_API_URL) + "?since=" + syncedSegmentCount + "&hash=" + hashHex;
 
-  Serial.println("Making API request...");
+  Serial.printf("Making API request, %d segments synced...\n", syncedSegmentCount);
 
   // Make the request
-  http.begin(client, KIWI_API_URL);
+  const char *headerKeys[] = {"X-Kiwi-Since", "X-Kiwi-Hash"};
+  http.collectHeaders(headerKeys, 2);
+  WiFiClientSecure *client = TlsPool::connectUrl(url.c_str(), this);
+  if (!client)
+  {
+    free(workingBuffer);
+    workingBuffer = NULL;
+    return false;
+  }
+  http.begin(*client, url);
   int httpCode = http.GET();
 
+  bool success = false;
   if (httpCode > 0)
   {
     Serial.printf("HTTP response code: %d\n", httpCode);
 
-    if (httpCode == HTTP_CODE_OK)
+    if (httpCode == HTTP_CODE_NO_CONTENT)
     {
-      // Get the response stream
-      WiFiClient *stream = http.getStreamPtr();
+      // Nothing new since the last sync
+      Serial.println("Kiwi data is up to date");
+      success = true;
+    }
+    else if (httpCode == HTTP_CODE_OK)
+    {
+      // Only a server that accepted our hash answers with a delta
+      bool incremental = syncedSegmentCount > 0 && http.hasHeader("X-Kiwi-Since") &&
+                         http.header("X-Kiwi-Since").toInt() == syncedSegmentCount;
+      if (incremental)
+      {
+        segmentCount = syncedSegmentCount;
+        Serial.printf("Receiving segments after #%d\n", syncedSegmentCount);
+      }
+      else
+      {
+        segmentCount = 0;
+        contentHash = FNV_OFFSET_BASIS;
+        Serial.println("Receiving all segments");
+      }
 
-      // Reset working buffer position
-      workingBufferPos = 0;
+      if (openOutputFile())
+      {
+        // Get the response stream
+        WiFiClient *stream = http.getStreamPtr();
 
-      // Process the incoming data in chunks
-      Serial.println("Starting to process stream...");
-      processStream(stream);
+        // Reset working buffer position
+        workingBufferPos = 0;
 
-      // Process any remaining data in the working buffer
-      if (workingBufferPos > 0)
-      {
-        writeSegmentToFile();
-      }
+        // Process the incoming data in chunks
+        Serial.println("Starting to process stream...");
+        processStream(stream);
 
-      // Close the output file
-      closeOutputFile();
+        // Process any remaining data in the working buffer
+        if (workingBufferPos > 0)
+        {
+          writeSegmentToFile();
+        }
 
-      Serial.printf("Stream processing complete! Total bytes written: %u KB\n", totalBytesWritten / 1024);
-      Serial.printf("Total segments written: %d\n", segmentCount);
+        // Close the output file
+        closeOutputFile();
 
-      http.end();
-      if (workingBuffer != NULL)
-      {
-        free(workingBuffer);
-        workingBuffer = NULL;
+        // Move the segments into the record store read by the menu
+        String storeFile = RecordStore::storeNameFor(outputFilename);
+        if (outputFile.failed())
+        {
+          Serial.printf("Error: Writing %s failed\n", outputFilename);
+        }
+        else if (incremental)
+        {
+          success = RecordStore::append(outputFilename, storeFile.c_str());
+        }
+        else
+        {
+          success = RecordStore::ingest(outputFilename, storeFile.c_str());
+        }
+
+        // A delta left behind would be taken for the full set by the menu,
+        // which ingests leftover text files; drop it and rebuild next time
+        if (!success && (incremental || outputFile.failed()))
+        {
+          LittleFS.remove(outputFilename);
+        }
+
+        syncedSegmentCount = success ? segmentCount : 0;
+        if (success && http.hasHeader("X-Kiwi-Hash") &&
+            strtoul(http.header("X-Kiwi-Hash").c_str(), NULL, 16) != contentHash)
+        {
+          Serial.println("Kiwi content hash mismatch, next sync rebuilds");
+          syncedSegmentCount = 0;
+        }
+        saveSyncState();
+
+        Serial.printf("Stream processing complete! Total bytes written: %u KB\n", totalBytesWritten / 1024);
+        Serial.printf("Total segments: %d\n", segmentCount);
+        FileSink::printStats("Kiwi sync");
       }
-      return true;
     }
   }
   else
@@ -193,18 +253,21 @@ bool Kiwi::processApiData()
   closeOutputFile();
 
   http.end();
+  TlsPool::release(this);
   if (workingBuffer != NULL)
   {
     free(workingBuffer);
     workingBuffer = NULL;
   }
-  return false;
+  return success;
 }
 
+// data.json is revalidated against the asset host and never rewritten
+// here, the record store is what knows how many segments there are
 bool Kiwi::isDataAvailable()
 {
-  this->loadMetadata();
-  return segmentCount > 0;
+  RecordStore store;
+  return store.open(RecordStore::storeNameFor(outputFilename).c_str()) && store.count() > 0;
 }
 
 void Kiwi::processStream(WiFiClient *stream)
@@ -447,14 +510,14 @@ void Kiwi::writeSegmentToFile()
     return; // Nothing to write or file not open
   }
 
-  // Write the segment data
+  // Write the segment data, the sink batches it into whole flash pages
+  hashSegment(workingBuffer, workingBufferPos);
   size_t bytesWritten = outputFile.write(workingBuffer, workingBufferPos);
 
   // Write a newline character after the segment
   if (bytesWritten == workingBufferPos)
   {
-    outputFile.write('\n');
-    bytesWritten++; // Include the newline in the count
+    bytesWritten += outputFile.write((uint8_t)'\n'); // Include the newline in the count
   }
 
   if (bytesWritten != workingBufferPos + 1) // +1 for newline
@@ -469,79 +532,3 @@ void Kiwi::writeSegmentToFile()
     Serial.printf("Total bytes written: %u KB\n", totalBytesWritten / 1024);
   }
 }
-
-// New method to update the JSON file
-void Kiwi::updateJsonFile(uint16_t segmentCount)
-{
-
-  // Check if JSON file exists
-  if (!LittleFS.exists(jsonFilename))
-  {
-    Serial.printf("JSON file %s not found, cannot update\n", jsonFilename);
-    return;
-  }
-
-  Serial.printf("Updating JSON file %s with new segment count: %d\n", jsonFilename, segmentCount);
-
-  // Open JSON file for reading
-  File jsonFile = LittleFS.open(jsonFilename, "r");
-  if (!jsonFile)
-  {
-    Serial.printf("Failed to open JSON file %s for reading\n", jsonFilename);
-    return;
-  }
-
-  // Read the entire file into a string
-  String jsonString = jsonFile.readString();
-  jsonFile.close();
-
-  // Allocate the JSON document
-  JsonDocument doc;
-
-  // Parse the JSON string
-  DeserializationError error = deserializeJson(doc, jsonString);
-  if (error)
-  {
-    Serial.printf("Failed to parse JSON: %s\n", error.c_str());
-    return;
-  }
-
-  // Find and update the "kiwi" entry
-  bool kiwiFound = false;
-  for (JsonVariant item : doc.as<JsonArray>())
-  {
-    if (item["menu"] == "kiwi")
-    {
-      item["numrec"] = segmentCount;
-      kiwiFound = true;
-      Serial.println("Updated 'kiwi' entry in JSON");
-      break;
-    }
-  }
-
-  if (!kiwiFound)
-  {
-    Serial.println("Warning: 'kiwi' entry not found in JSON");
-    return;
-  }
-
-  // Open the file for writing
-  jsonFile = LittleFS.open(jsonFilename, "w");
-  if (!jsonFile)
-  {
-    Serial.printf("Failed to open JSON file %s for writing\n", jsonFilename);
-    return;
-  }
-
-  // Serialize the modified JSON back to the file
-  if (serializeJson(doc, jsonFile) == 0)
-  {
-    Serial.println("Failed to write JSON to file");
-  }
-  else
-  {
-    Serial.println("Successfully updated JSON file");
-  }
-
-  jsonFile.close();
-}
\ No newline at end of file
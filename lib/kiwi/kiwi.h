@@ -5,9 +5,27 @@
 #include <ESP8266WiFi.h>
 #include <ESP8266HTTPClient.h>
 #include <LittleFS.h>
+#include <filesink.h>
+#include <tlspool.h>
 
 #define KIWI_API_URL "https://kiwidesschicksals.de/kiwi2.php"
 
+// Incremental sync
+//
+// The request carries the number of segments already stored and a
+// FNV-1a hash over them (each segment followed by '\n', as written to
+// the text file): KIWI_API_URL?since=<count>&hash=<8 hex digits>.
+// A server that recognises the hash answers with only the newer segments
+// and echoes the count in X-Kiwi-Since; any other answer is taken as the
+// full set and rebuilds the store. An optional X-Kiwi-Hash header with
+// the hash over all segments is checked after the update, a mismatch
+// forces a full rebuild on the next sync. A delta that cannot be
+// appended is deleted rather than left for the menu to ingest.
+//
+// The menu takes the number of records from the store, data.json is
+// left as downloaded. The firmware has no caller for processApiData()
+// yet, the kiwi item is also left out of the asset sync.
+
 class Kiwi
 {
 public:
@@ -38,8 +56,12 @@ private:
   // File handling
   uint16_t segmentCount;
   const char *outputFilename = "/kiwi.txt"; // Default output filename
-  const char *jsonFilename = "/data.json";
-  File outputFile;
+  const char *syncFilename = "/kiwi.sync";
+  FileSink outputFile;
+
+  // Sync state: segments in the record store and their hash
+  uint16_t syncedSegmentCount;
+  uint32_t contentHash;
 
   // Track total bytes written to filesystem
   size_t totalBytesWritten;
@@ -56,8 +78,9 @@ private:
   bool openOutputFile();
   void writeSegmentToFile();
   void closeOutputFile();
-  void loadMetadata(); 
-  void updateJsonFile(uint16_t segmentCount); 
+  void loadSyncState();
+  void saveSyncState();
+  void hashSegment(const uint8_t *data, size_t length);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef TLS_PINS_H
+#define TLS_PINS_H
+
+#include <Arduino.h>
+
+// Trust anchors that ship with the firmware, see TlsPool
+//
+// Roots rather than server keys: the hosts rotate their keys and
+// certificates every few months, their CAs stay for years. A host that
+// moves to another CA needs an entry here or a TLS_POOL_PIN_DIR file.
+struct TlsPin
+{
+  const char *host;
+  const char *anchors; // PEM certificates in PROGMEM
+};
+
+#define TLS_PIN_COUNT 2
+
+extern const TlsPin TLS_PINS[TLS_PIN_COUNT];
+
+#endif // TLS_PINS_H
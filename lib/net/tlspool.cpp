@@ -0,0 +1,236 @@
+#include "tlspool.h"
+#include "tlspins.h"
+#include <LittleFS.h>
+#include <time.h>
+
+TlsPool::Host TlsPool::hosts[TLS_POOL_HOSTS];
+TlsPool::Pin TlsPool::pins[TLS_POOL_PINS];
+uint32_t TlsPool::useCounter = 0;
+std::unique_ptr<WiFiClientSecure> TlsPool::client;
+TlsPool::Host *TlsPool::clientHost = nullptr;
+const void *TlsPool::clientOwner = nullptr;
+TlsPoolStats TlsPool::totals;
+std::unique_ptr<BearSSL::PublicKey> TlsPool::clientKey;
+std::unique_ptr<BearSSL::X509List> TlsPool::clientAnchors;
+
+void TlsPool::begin() {
+  for (const TlsPin &builtIn : TLS_PINS) {
+    addPin(builtIn.host, builtIn.anchors);
+  }
+
+  // Files replace the built-in pins, they are read on each connect
+  Dir dir = LittleFS.openDir(TLS_POOL_PIN_DIR);
+  while (dir.next()) {
+    String name = dir.fileName();
+    if (name.endsWith(".pem")) {
+      addPin(name.substring(0, name.length() - 4).c_str(), nullptr);
+    }
+  }
+}
+
+WiFiClientSecure *TlsPool::connect(const char *name, uint16_t port, const void *owner, bool *reused) {
+  // Refuse rather than close a connection that is still being read
+  if (isBusy(owner)) {
+    Serial.printf("TlsPool: Busy, %s has to wait\n", name);
+    totals.busy++;
+    return nullptr;
+  }
+
+  Host &host = hostFor(name, port);
+  host.lastUsed = ++useCounter;
+
+  if (client && clientHost == &host && client->connected()) {
+    clientOwner = owner;
+    totals.reused++;
+    if (reused) {
+      *reused = true;
+    }
+    return client.get();
+  }
+  if (reused) {
+    *reused = false;
+  }
+
+  // Only one connection holds TLS buffers
+  closeClient();
+
+  client.reset(new WiFiClientSecure());
+  const Pin *pin = pinFor(name);
+  if (!pin) {
+    client->setInsecure();
+  } else if (!applyPin(*pin)) {
+    // Never fall back to an unverified connection
+    totals.failures++;
+    closeClient();
+    return nullptr;
+  }
+
+  if (host.mfln < 0) {
+    host.mfln = WiFiClientSecure::probeMaxFragmentLength(name, port, TLS_POOL_MFLN_SIZE) ? 1 : 0;
+    Serial.printf("TlsPool: %s %s MFLN %u\n", name, host.mfln ? "supports" : "does not support",
+                  TLS_POOL_MFLN_SIZE);
+  }
+  client->setSession(&host.session);
+  if (host.mfln) {
+    client->setBufferSizes(TLS_POOL_MFLN_SIZE, TLS_POOL_TX_BUFFER);
+  }
+
+  unsigned long start = millis();
+  bool connected = client->connect(name, port);
+  unsigned long elapsed = millis() - start;
+  if (!connected) {
+    char error[64];
+    client->getLastSSLError(error, sizeof(error));
+    Serial.printf("TlsPool: Connecting to %s failed after %lu ms: %s\n", name, elapsed, error);
+    totals.failures++;
+    closeClient();
+    return nullptr;
+  }
+
+  totals.handshakes++;
+  totals.handshakeMillis += elapsed;
+  Serial.printf("TlsPool: Connected to %s in %lu ms\n", name, elapsed);
+  clientHost = &host;
+  clientOwner = owner;
+  return client.get();
+}
+
+WiFiClientSecure *TlsPool::connectUrl(const char *url, const void *owner, bool *reused) {
+  if (strncmp(url, "https://", 8) != 0) {
+    return nullptr;
+  }
+  const char *start = url + 8;
+  size_t length = strcspn(start, ":/?");
+  if (length == 0 || length >= TLS_POOL_HOST_MAX) {
+    return nullptr;
+  }
+
+  char name[TLS_POOL_HOST_MAX];
+  memcpy(name, start, length);
+  name[length] = '\0';
+  uint16_t port = start[length] == ':' ? atoi(start + length + 1) : 443;
+  return connect(name, port, owner, reused);
+}
+
+void TlsPool::release(const void *owner) {
+  if (clientOwner == owner) {
+    clientOwner = nullptr;
+  }
+}
+
+void TlsPool::close(const void *owner) {
+  if (clientOwner == owner) {
+    closeClient();
+  }
+}
+
+void TlsPool::closeClient() {
+  if (client) {
+    client->stop();
+    client.reset();
+  }
+  clientKey.reset();
+  clientAnchors.reset();
+  clientHost = nullptr;
+  clientOwner = nullptr;
+}
+
+bool TlsPool::pin(const char *name, const char *pem) {
+  // Applies from the next connection, one in use keeps its pin
+  return addPin(name, pem);
+}
+
+void TlsPool::printStats() {
+  Serial.printf("TLS: %u handshakes in %u ms, %u reused, %u failed, %u busy\n", totals.handshakes,
+                totals.handshakeMillis, totals.reused, totals.failures, totals.busy);
+}
+
+// The entry of a host, the least recently used one is replaced
+TlsPool::Host &TlsPool::hostFor(const char *name, uint16_t port) {
+  Host *oldest = nullptr;
+  for (Host &host : hosts) {
+    if (host.port == port && strcmp(host.name, name) == 0) {
+      return host;
+    }
+    // The host of an owned connection stays, the caller owns it or
+    // connect() has refused already
+    if (&host == clientHost && clientOwner) {
+      continue;
+    }
+    if (!oldest || host.lastUsed < oldest->lastUsed) {
+      oldest = &host;
+    }
+  }
+
+  if (clientHost == oldest) {
+    closeClient();
+  }
+  strlcpy(oldest->name, name, sizeof(oldest->name));
+  oldest->port = port;
+  oldest->session = BearSSL::Session();
+  oldest->mfln = -1;
+  oldest->lastUsed = 0;
+  return *oldest;
+}
+
+TlsPool::Pin *TlsPool::pinFor(const char *name) {
+  for (Pin &pin : pins) {
+    if (strcmp(pin.name, name) == 0) {
+      return &pin;
+    }
+  }
+  return nullptr;
+}
+
+bool TlsPool::addPin(const char *name, const char *pem) {
+  Pin *pin = pinFor(name);
+  if (!pin) {
+    pin = pinFor("");
+  }
+  if (!pin || strlen(name) >= TLS_POOL_HOST_MAX) {
+    Serial.printf("TlsPool: No room to pin %s\n", name);
+    return false;
+  }
+  strlcpy(pin->name, name, sizeof(pin->name));
+  pin->pem = pem;
+  return true;
+}
+
+// Parse the pin into the new client
+bool TlsPool::applyPin(const Pin &pin) {
+  String pem;
+  if (pin.pem) {
+    pem = FPSTR(pin.pem);
+  } else {
+    String path = String(TLS_POOL_PIN_DIR) + pin.name + ".pem";
+    File file = LittleFS.open(path, "r");
+    if (file) {
+      pem = file.readString();
+      file.close();
+    }
+  }
+
+  if (pem.indexOf("PUBLIC KEY") >= 0) {
+    clientKey.reset(new BearSSL::PublicKey(pem.c_str()));
+    if (!clientKey->isRSA() && !clientKey->isEC()) {
+      Serial.printf("TlsPool: Invalid pinned key for %s\n", pin.name);
+      return false;
+    }
+    client->setKnownKey(clientKey.get());
+    return true;
+  }
+
+  time_t now = time(nullptr);
+  if (now < TLS_POOL_MIN_TIME) {
+    Serial.printf("TlsPool: Clock not set, cannot verify %s yet\n", pin.name);
+    return false;
+  }
+  clientAnchors.reset(new BearSSL::X509List(pem.c_str()));
+  if (clientAnchors->getCount() == 0) {
+    Serial.printf("TlsPool: Invalid pinned certificates for %s\n", pin.name);
+    return false;
+  }
+  client->setTrustAnchors(clientAnchors.get());
+  client->setX509Time(now);
+  return true;
+}
@@ -0,0 +1,129 @@
+#ifndef TLS_POOL_H
+#define TLS_POOL_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <memory>
+
+// Hosts that keep a TLS session, and hosts with a pin
+#define TLS_POOL_HOSTS 4
+#define TLS_POOL_PINS 6
+#define TLS_POOL_HOST_MAX 48
+
+// Record size asked for with the max fragment length extension. Servers
+// that accept it let the receive buffer shrink from 16 KB to this.
+#define TLS_POOL_MFLN_SIZE 1024
+#define TLS_POOL_TX_BUFFER 512
+
+// Pins on LittleFS, "/tls/<host>.pem" with a PEM public key or PEM
+// certificates. They replace the built-in pins of tlspins.h.
+#define TLS_POOL_PIN_DIR "/tls/"
+
+// Certificates are checked against the clock, an earlier time means it
+// is not set yet (2024-01-01)
+#define TLS_POOL_MIN_TIME 1704067200
+
+// Handshake counters since boot
+struct TlsPoolStats
+{
+  uint32_t handshakes = 0;     // New connections, full or resumed
+  uint32_t handshakeMillis = 0; // Time spent in them, DNS and TCP included
+  uint32_t failures = 0;       // Connections that failed
+  uint32_t reused = 0;         // Requests served on an open connection
+  uint32_t busy = 0;           // Requests refused while another owner held it
+};
+
+// Shared HTTPS connections
+//
+// Every handshake costs the ESP8266 seconds of CPU and buffers of about
+// 20 KB, so all HTTPS users share one client through this pool:
+//
+// - The connection has one owner at a time, the token passed to
+//   connect(), usually `this`. Another owner is refused with nullptr
+//   until the owner calls release() or close(), it never takes over a
+//   connection that is still being read.
+// - A released connection stays open and is reused while requests go to
+//   the same host. A request for another host closes it, so only one TLS
+//   connection holds buffers at any time.
+// - Each host keeps its BearSSL session, reconnects resume it and skip
+//   the key exchange.
+// - Whether a host supports MFLN is probed once per boot. If it does,
+//   the receive buffer is TLS_POOL_MFLN_SIZE instead of 16 KB.
+// - A pinned host is only accepted with its pin: a server public key, or
+//   root certificates its chain has to lead to. The asset and AI hosts
+//   are pinned to their CAs, see tlspins.h. A pinned host is never
+//   connected unverified, certificates wait until the clock is set.
+//   Hosts without a pin are not verified.
+//
+// The client returned by connect() is only valid until its owner calls
+// close(), or release() followed by another owner's connect().
+class TlsPool
+{
+public:
+  // Connected client for host:port owned by `owner`, nullptr if the
+  // connection failed or another owner holds it. `reused` tells whether
+  // an open connection was handed out.
+  static WiFiClientSecure *connect(const char *host, uint16_t port, const void *owner, bool *reused = nullptr);
+
+  // Connect for an https:// URL
+  static WiFiClientSecure *connectUrl(const char *url, const void *owner, bool *reused = nullptr);
+
+  // Give up ownership, the connection stays open for reuse
+  static void release(const void *owner);
+
+  // Close the connection if `owner` holds it, sessions are kept
+  static void close(const void *owner);
+
+  // Another owner holds the connection
+  static bool isBusy(const void *owner) { return clientOwner && clientOwner != owner; }
+
+  // Whether `connection` is still the open connection
+  static bool isOpen(const WiFiClient *connection) { return connection && connection == client.get(); }
+
+  // Load the built-in pins and those of TLS_POOL_PIN_DIR, once at boot
+  // with LittleFS mounted
+  static void begin();
+
+  // Pin a host to a PEM public key or PEM certificates in PROGMEM, which
+  // have to outlive the pool. Parsed for each new connection.
+  static bool pin(const char *host, const char *pem);
+
+  static const TlsPoolStats &stats() { return totals; }
+  static void printStats();
+
+private:
+  struct Host
+  {
+    char name[TLS_POOL_HOST_MAX];
+    uint16_t port;
+    BearSSL::Session session;
+    int8_t mfln; // -1 not probed yet, 0 unsupported, 1 supported
+    uint32_t lastUsed;
+  };
+
+  struct Pin
+  {
+    char name[TLS_POOL_HOST_MAX];
+    const char *pem; // PROGMEM, nullptr for a TLS_POOL_PIN_DIR file
+  };
+
+  static Host hosts[TLS_POOL_HOSTS];
+  static Pin pins[TLS_POOL_PINS];
+  static uint32_t useCounter;
+  static std::unique_ptr<WiFiClientSecure> client;
+  static Host *clientHost;
+  static const void *clientOwner;
+  static TlsPoolStats totals;
+
+  // The parsed pin of the open connection, freed with it
+  static std::unique_ptr<BearSSL::PublicKey> clientKey;
+  static std::unique_ptr<BearSSL::X509List> clientAnchors;
+
+  static Host &hostFor(const char *name, uint16_t port);
+  static Pin *pinFor(const char *name);
+  static bool addPin(const char *name, const char *pem);
+  static bool applyPin(const Pin &pin);
+  static void closeClient();
+};
+
+#endif // TLS_POOL_H
@@ -4,6 +4,36 @@ FileDownloader::FileDownloader() {
   // Initialize any class members here
 }
 
+FileDownloader::~FileDownloader() {
+  end();
+}
+
+void FileDownloader::end() {
+  // An unfinished body stays as a temp file to resume
+  transferring = false;
+  sink.close();
+  https.setReuse(false);
+  https.end();
+  if (plainClient) {
+    plainClient->stop();
+    plainClient.reset();
+  }
+
+  // Only a connection this downloader holds, another user may be reading
+  TlsPool::close(this);
+}
+
+WiFiClient* FileDownloader::clientFor(const char* url) {
+  // Plain http:// is allowed so a local server can stand in for GitHub
+  if (strncmp(url, "https://", 8) == 0) {
+    return TlsPool::connectUrl(url, this);
+  }
+  if (!plainClient) {
+    plainClient.reset(new WiFiClient());
+  }
+  return plainClient.get();
+}
+
 bool FileDownloader::begin() {
   if (!LittleFS.begin()) {
     Serial.println("Failed to mount LittleFS");
@@ -13,82 +43,304 @@ bool FileDownloader::begin() {
 }
 
 bool FileDownloader::downloadFile(const char* url, const char* filename) {
-  // Create a new HTTP client
-  WiFiClientSecure client;
-  
-  // Skip certificate verification (for simplicity)
-  client.setInsecure();
-  
-  HTTPClient https;
+  Progress progress = start(url, filename);
+  while (progress == Progress::RUNNING) {
+    progress = step(SIZE_MAX);
+    yield();
+  }
+  return progress == Progress::DONE;
+}
+
+FileDownloader::Progress FileDownloader::start(const char* url, const char* filename, bool ingested) {
+  String tmpFilename = tempName(filename);
+  modified = false;
+  if (transferring) {
+    // A download left unfinished, keep what it has for a resume
+    sink.close();
+    https.end();
+    transferring = false;
+  }
+
+  // ETag of the complete file, used to skip unchanged downloads. A file
+  // that does not match its recorded size must not be confirmed by a 304.
+  // An ingested file is gone, its sidecar still names the version held.
+  String etag;
+  size_t recordedSize = 0;
+  bool haveSidecar = (ingested || isComplete(filename)) && readSidecar(filename, etag, recordedSize);
+
+  // A leftover temp file from an interrupted download can be resumed,
+  // but only if we know which version of the resource it belongs to
+  size_t resumeFrom = 0;
+  String partialEtag;
+  size_t partialSize = 0;
+  if (LittleFS.exists(tmpFilename)) {
+    File partial = LittleFS.open(tmpFilename, "r");
+    if (partial) {
+      resumeFrom = partial.size();
+      partial.close();
+    }
+    if (resumeFrom == 0 || !readSidecar(tmpFilename.c_str(), partialEtag, partialSize) || partialEtag.isEmpty() ||
+        (partialSize > 0 && resumeFrom > partialSize)) {
+      LittleFS.remove(tmpFilename);
+      LittleFS.remove(sidecarName(tmpFilename.c_str()));
+      resumeFrom = 0;
+    } else if (resumeFrom == partialSize) {
+      // Interrupted between the last byte and the rename
+      Serial.printf("%s was already complete\n", tmpFilename.c_str());
+      return finishDownload(filename, partialEtag) ? Progress::DONE : Progress::FAILED;
+    }
+  }
+
   Serial.print("Downloading from: ");
   Serial.println(url);
-  
-  if (!https.begin(client, url)) {
+
+  // Keep-alive needs HTTP/1.1; otherwise HTTP/1.0 keeps the body free
+  // of chunked framing
+  https.useHTTP10(!keepAlive);
+  https.setReuse(keepAlive);
+  const char* headerKeys[] = {"ETag", "Content-Range"};
+  https.collectHeaders(headerKeys, 2);
+
+  WiFiClient* client = clientFor(url);
+  if (!client || !https.begin(*client, url)) {
     Serial.println("HTTPS connection failed");
-    return false;
+    return Progress::FAILED;
+  }
+
+  if (resumeFrom > 0) {
+    Serial.printf("Resuming %s at byte %u\n", filename, resumeFrom);
+    https.addHeader("Range", "bytes=" + String(resumeFrom) + "-");
+    https.addHeader("If-Range", partialEtag);
+  } else if (haveSidecar && !etag.isEmpty()) {
+    https.addHeader("If-None-Match", etag);
   }
-  
+
   int httpCode = https.GET();
-  if (httpCode != HTTP_CODE_OK) {
+  if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+    Serial.printf("%s is up to date\n", filename);
+    https.end();
+    return Progress::DONE;
+  }
+
+  if (httpCode == HTTP_CODE_RANGE_NOT_SATISFIABLE && resumeFrom > 0) {
+    // Nothing left after the partial file: complete if the server size
+    // agrees, otherwise it cannot be resumed
+    String range = https.header("Content-Range");
+    int slash = range.lastIndexOf('/');
+    size_t total = slash >= 0 ? range.substring(slash + 1).toInt() : 0;
+    https.end();
+    if (total == resumeFrom) {
+      return finishDownload(filename, partialEtag) ? Progress::DONE : Progress::FAILED;
+    }
+    Serial.printf("Cannot resume %s, starting over next time\n", filename);
+    LittleFS.remove(tmpFilename);
+    LittleFS.remove(sidecarName(tmpFilename.c_str()));
+    return Progress::FAILED;
+  }
+
+  if (httpCode == HTTP_CODE_PARTIAL_CONTENT && resumeFrom > 0) {
+    // Appending any other range than the one asked for would corrupt the
+    // file, drop the partial file and fetch the whole body instead
+    String range = https.header("Content-Range");
+    size_t first = range.substring(range.indexOf(' ') + 1).toInt();
+    if (first != resumeFrom) {
+      Serial.printf("Range of %s starts at %u, not %u, starting over\n", filename, first, resumeFrom);
+      // The rest of the body is still on the wire, the connection can't be reused
+      https.setReuse(false);
+      https.end();
+      LittleFS.remove(tmpFilename);
+      LittleFS.remove(sidecarName(tmpFilename.c_str()));
+      return start(url, filename, ingested);
+    }
+    sink.open(tmpFilename, "a");
+  } else if (httpCode == HTTP_CODE_OK) {
+    // Full body, either a fresh download or the resource changed under us
+    partialEtag = https.header("ETag");
+    int size = https.getSize();
+    writeSidecar(tmpFilename.c_str(), partialEtag, size > 0 ? size : 0);
+    sink.open(tmpFilename, "w");
+  } else {
     Serial.print("HTTP GET failed, error code: ");
     Serial.println(httpCode);
     https.end();
-    return false;
+    return Progress::FAILED;
   }
-  
-  // Get the content length
+
+  // Get the content length of this response
   int contentLength = https.getSize();
   Serial.print("Content length: ");
   Serial.println(contentLength);
-  
-  // Create or open the file for writing
-  File file = LittleFS.open(filename, "w");
-  if (!file) {
+
+  if (!sink) {
     Serial.println("Failed to open file for writing");
     https.end();
-    return false;
+    return Progress::FAILED;
   }
-  
-  return downloadToFile(https, file, contentLength);
+
+  target = filename;
+  targetEtag = partialEtag;
+  expected = contentLength >= 0 ? (size_t)contentLength : SIZE_MAX;
+  received = 0;
+  lastDataTime = millis();
+  chunkedBody = contentLength < 0 && keepAlive;
+  transferring = true;
+  return Progress::RUNNING;
 }
 
-bool FileDownloader::downloadToFile(HTTPClient& https, File& file, size_t contentLength) {
-  // Get the HTTP stream
+FileDownloader::Progress FileDownloader::step(size_t maxBytes) {
+  if (!transferring) {
+    return Progress::FAILED;
+  }
+
+  if (chunkedBody) {
+    // Chunked HTTP/1.1 body, HTTPClient strips the framing but only
+    // while reading all of it
+    int written = https.writeToStream(&sink.rawFile());
+    if (written < 0) {
+      transferring = false;
+      sink.close();
+      https.end();
+      Serial.printf("Download of %s incomplete, will resume later\n", target.c_str());
+      return Progress::FAILED;
+    }
+    received = written;
+    return endTransfer();
+  }
+
+  // The stream is read straight into the sink buffer, which goes to
+  // LittleFS in whole pages
   WiFiClient* stream = https.getStreamPtr();
-  
-  // Read from HTTP and write to file
-  uint8_t buffer[128];
-  size_t bytesDownloaded = 0;
-  
-  while (https.connected() && (bytesDownloaded < contentLength)) {
+  size_t copied = 0;
+  while (copied < maxBytes && received < expected && !sink.failed()) {
     size_t bytesAvailable = stream->available();
-    
-    if (bytesAvailable) {
-      size_t bytesToRead = min(bytesAvailable, sizeof(buffer));
-      size_t bytesRead = stream->readBytes(buffer, bytesToRead);
-      
-      if (bytesRead > 0) {
-        file.write(buffer, bytesRead);
-        bytesDownloaded += bytesRead;
-        
-        // Print progress
-        Serial.print("Downloaded: ");
-        Serial.print(bytesDownloaded);
-        Serial.print(" of ");
-        Serial.println(contentLength);
-      }
+    if (!bytesAvailable) {
+      break;
+    }
+    uint8_t* space;
+    size_t bytesToRead = min(bytesAvailable, sink.reserve(space));
+    bytesToRead = min(bytesToRead, expected - received);
+    bytesToRead = min(bytesToRead, maxBytes - copied);
+    size_t bytesRead = stream->read(space, bytesToRead);
+    if (!bytesRead) {
+      break;
     }
-    delay(1);
+    sink.commit(bytesRead);
+    received += bytesRead;
+    copied += bytesRead;
   }
-  
-  file.close();
-  Serial.println("File saved to LittleFS");
+  if (copied) {
+    lastDataTime = millis();
+  }
+
+  bool more = received < expected && !sink.failed();
+  if (more && stream->available()) {
+    return Progress::RUNNING;
+  }
+  if (more && stream->connected()) {
+    if (millis() - lastDataTime <= DOWNLOAD_STALL_TIMEOUT) {
+      return Progress::RUNNING;
+    }
+    Serial.println("Download stalled");
+  }
+  return endTransfer();
+}
+
+FileDownloader::Progress FileDownloader::endTransfer() {
+  transferring = false;
+  sink.close();
   https.end();
+
+  if (sink.failed()) {
+    Serial.println("Failed to write to LittleFS");
+    return Progress::FAILED;
+  }
+
+  // Without a Content-Length the body ends when the server closes
+  bool complete = expected == SIZE_MAX || received == expected;
+  Serial.printf("Downloaded %u bytes%s\n", received, complete ? "" : " (truncated)");
+  if (!complete) {
+    // Keep the temp file and its sidecar so the next attempt can resume
+    Serial.printf("Download of %s incomplete, will resume later\n", target.c_str());
+    return Progress::FAILED;
+  }
+
+  return finishDownload(target.c_str(), targetEtag) ? Progress::DONE : Progress::FAILED;
+}
+
+// Swap the finished temp file into place
+bool FileDownloader::finishDownload(const char* filename, const String& etag) {
+  String tmpFilename = tempName(filename);
+  File done = LittleFS.open(tmpFilename, "r");
+  size_t finalSize = done ? done.size() : 0;
+  if (done) {
+    done.close();
+  }
+  if (!LittleFS.rename(tmpFilename, filename)) {
+    Serial.printf("Failed to rename %s\n", tmpFilename.c_str());
+    return false;
+  }
+  writeSidecar(filename, etag, finalSize);
+  LittleFS.remove(sidecarName(tmpFilename.c_str()));
+  modified = true;
   return true;
 }
 
+bool FileDownloader::isComplete(const char* filename) {
+  if (!LittleFS.exists(filename)) {
+    return false;
+  }
+
+  String etag;
+  size_t recordedSize = 0;
+  if (!readSidecar(filename, etag, recordedSize) || recordedSize == 0) {
+    // Files from older firmware have no sidecar, trust them
+    return true;
+  }
+
+  File file = LittleFS.open(filename, "r");
+  if (!file) {
+    return false;
+  }
+  size_t size = file.size();
+  file.close();
+  return size == recordedSize;
+}
+
+String FileDownloader::tempName(const char* filename) {
+  return String(filename) + ".tmp";
+}
+
+String FileDownloader::sidecarName(const char* filename) {
+  return String(filename) + ".etag";
+}
+
+// Sidecar layout: first line ETag, second line size in bytes
+bool FileDownloader::readSidecar(const char* filename, String& etag, size_t& size) {
+  File sidecar = LittleFS.open(sidecarName(filename), "r");
+  if (!sidecar) {
+    return false;
+  }
+  etag = sidecar.readStringUntil('\n');
+  size = sidecar.readStringUntil('\n').toInt();
+  sidecar.close();
+  return true;
+}
+
+void FileDownloader::writeSidecar(const char* filename, const String& etag, size_t size) {
+  File sidecar = LittleFS.open(sidecarName(filename), "w");
+  if (!sidecar) {
+    Serial.printf("Failed to write sidecar for %s\n", filename);
+    return;
+  }
+  sidecar.print(etag);
+  sidecar.print('\n');
+  sidecar.print(size);
+  sidecar.print('\n');
+  sidecar.close();
+}
+
 // Legacy function to maintain backward compatibility
 bool download_file(const char* url, const char* filename) {
   FileDownloader downloader;
   return downloader.downloadFile(url, filename);
-}
\ No newline at end of file
+}
@@ -5,24 +5,113 @@
 #include <LittleFS.h>
 #include <ESP8266WiFi.h>
 #include <ESP8266HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <memory>
+#include "filesink.h"
+#include "tlspool.h"
+
+// Abort a download if no data arrives for this long (ms)
+#define DOWNLOAD_STALL_TIMEOUT 10000
+
+// Most bytes one step() copies by default, four sink buffers
+#define DOWNLOAD_STEP_SIZE (4 * FILE_SINK_BUFFER_SIZE)
 
 // Class for handling file downloads from the internet
+//
+// Downloads are written to "<filename>.tmp" and renamed into place only
+// once the full body has arrived, so a dropped connection never leaves a
+// truncated file under the real name. A partial temp file is resumed with
+// an HTTP Range request on the next attempt. The server ETag and the file
+// size are kept in "<filename>.etag"; a file that still has its recorded
+// size is revalidated with If-None-Match, so an unchanged one costs a 304.
+// A resumed body is only appended if its Content-Range starts where the
+// temp file ends, otherwise the download starts over.
+//
+// asset_stub.py serves a directory with ETag and Range support, and can
+// cut responses short, to try this against a local server.
+//
+// HTTPS connections come from TlsPool and stay owned by the downloader
+// until end(), which the destructor calls. With keep-alive enabled the
+// connection is kept between downloadFile calls, so a batch of files from
+// the same host pays for a single handshake. While another user holds the
+// pooled connection downloadFile fails at once.
+//
+// downloadFile blocks until the body is in. Callers that run from the
+// event loop use start() and then step() once per tick, which copies at
+// most a bounded slice of the body and returns at once when none is
+// waiting. Connecting and reading the response headers still block, up
+// to the HTTPClient timeout.
 class FileDownloader {
 public:
+  enum class Progress : uint8_t
+  {
+    RUNNING, // Call step() again
+    DONE,    // The file is in place and complete
+    FAILED
+  };
+
   FileDownloader();
-  
+  ~FileDownloader();
+
   // Initialize the file system
   bool begin();
-  
+
+  // Keep the connection open between downloads to the same host
+  void setKeepAlive(bool enabled) { keepAlive = enabled; }
+
+  // Close the connection and free the TLS buffers
+  void end();
+
   // Download a file from URL and save it to the specified filename
   bool downloadFile(const char* url, const char* filename);
-  
+
+  // Send the request for a download; DONE or FAILED when there is no body
+  // to copy, e.g. the file is current. An ingested file was removed after
+  // the download, its sidecar is used to revalidate it all the same.
+  Progress start(const char* url, const char* filename, bool ingested = false);
+
+  // Copy up to maxBytes of the body that has arrived
+  Progress step(size_t maxBytes = DOWNLOAD_STEP_SIZE);
+
+  // The last download replaced the file, rather than finding it current
+  bool wasModified() const { return modified; }
+
+  // Check that a downloaded file matches the size recorded in its sidecar
+  static bool isComplete(const char* filename);
+
 private:
-  // Helper function to download content to a file
-  bool downloadToFile(HTTPClient& https, File& file, size_t contentLength);
+  std::unique_ptr<WiFiClient> plainClient;
+  HTTPClient https;
+  bool keepAlive = false;
+  bool modified = false;
+
+  // Body transfer between start() and the end of the response
+  FileSink sink;
+  String target;
+  String targetEtag;
+  size_t expected = 0; // SIZE_MAX without a Content-Length
+  size_t received = 0;
+  unsigned long lastDataTime = 0;
+  bool transferring = false;
+  bool chunkedBody = false;
+
+  // Create or reuse the transport for the URL scheme, nullptr on failure
+  WiFiClient* clientFor(const char* url);
+
+  // Close the body transfer, then rename or keep the temp file to resume
+  Progress endTransfer();
+
+  // Rename the complete temp file into place and record its sidecar
+  bool finishDownload(const char* filename, const String& etag);
+
+  // Sidecar helpers
+  static String tempName(const char* filename);
+  static String sidecarName(const char* filename);
+  static bool readSidecar(const char* filename, String& etag, size_t& size);
+  static void writeSidecar(const char* filename, const String& etag, size_t size);
 };
 
 // Legacy function to maintain backward compatibility
 bool download_file(const char* url, const char* filename);
 
-#endif // FILE_DOWNLOADER_H
\ No newline at end of file
+#endif // FILE_DOWNLOADER_H
@@ -0,0 +1,121 @@
+#include "filesink.h"
+
+FileSinkStats FileSink::totals;
+
+FileSink::FileSink() : bufferFill(0), bufferLimit(FILE_SINK_BUFFER_SIZE), position(0), writeFailed(false)
+{
+}
+
+FileSink::~FileSink()
+{
+    close();
+}
+
+bool FileSink::open(const String &path, const char *mode)
+{
+    close();
+
+    file = LittleFS.open(path, mode);
+    if (!file)
+    {
+        return false;
+    }
+
+    if (!buffer)
+    {
+        buffer.reset(new uint8_t[FILE_SINK_BUFFER_SIZE]);
+    }
+
+    // Appending starts mid page, the first flush only completes that page
+    position = file.size();
+    bufferFill = 0;
+    bufferLimit = FILE_SINK_BUFFER_SIZE - position % FLASH_PAGE_SIZE;
+    writeFailed = false;
+    return true;
+}
+
+void FileSink::close()
+{
+    if (file)
+    {
+        flush();
+        file.close();
+    }
+}
+
+size_t FileSink::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t FileSink::write(const uint8_t *data, size_t length)
+{
+    if (!file)
+    {
+        return 0;
+    }
+
+    size_t written = 0;
+    while (written < length)
+    {
+        size_t chunk = min(length - written, bufferLimit - bufferFill);
+        memcpy(buffer.get() + bufferFill, data + written, chunk);
+        commit(chunk);
+        written += chunk;
+    }
+    return written;
+}
+
+size_t FileSink::reserve(uint8_t *&space)
+{
+    space = buffer.get() + bufferFill;
+    return file ? bufferLimit - bufferFill : 0;
+}
+
+void FileSink::commit(size_t length)
+{
+    bufferFill += length;
+    position += length;
+    totals.bytes += length;
+
+    if (bufferFill >= bufferLimit)
+    {
+        flush();
+    }
+}
+
+void FileSink::flush()
+{
+    if (bufferFill == 0 || !file)
+    {
+        return;
+    }
+
+    // Pages touched by this write, a partial page at either end counts
+    size_t start = position - bufferFill;
+    totals.pages += (position + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE - start / FLASH_PAGE_SIZE;
+    totals.writes++;
+
+    if (file.write(buffer.get(), bufferFill) != bufferFill)
+    {
+        writeFailed = true;
+    }
+    bufferFill = 0;
+    bufferLimit = FILE_SINK_BUFFER_SIZE - position % FLASH_PAGE_SIZE;
+}
+
+File &FileSink::rawFile()
+{
+    flush();
+    return file;
+}
+
+void FileSink::printStats(const char *label)
+{
+    // Pages touched per page of data, in hundredths
+    uint32_t dataPages = (totals.bytes + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    uint32_t amplification = dataPages ? totals.pages * 100 / dataPages : 0;
+    Serial.printf("%s: %u bytes in %u writes, %u pages, write amplification %u.%02u\n",
+                  label, totals.bytes, totals.writes, totals.pages,
+                  amplification / 100, amplification % 100);
+}
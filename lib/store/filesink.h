@@ -0,0 +1,83 @@
+#ifndef FILE_SINK_H
+#define FILE_SINK_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <memory>
+
+// LittleFS program granularity on the ESP8266 core
+#define FLASH_PAGE_SIZE 256
+
+// Write combining buffer, a whole number of flash pages
+#define FILE_SINK_BUFFER_SIZE (4 * FLASH_PAGE_SIZE)
+
+// Write counters, summed over all sinks since the last resetStats()
+struct FileSinkStats
+{
+  uint32_t bytes = 0;  // Bytes handed to the sinks
+  uint32_t writes = 0; // Writes issued to LittleFS
+  uint32_t pages = 0;  // Flash pages those writes touched
+};
+
+// Buffered file writer for LittleFS
+//
+// Every write to a LittleFS file programs at least one flash page and may
+// commit metadata, so small writes wear the flash far beyond their size.
+// FileSink collects writes in a page sized buffer and hands them to the
+// file system in whole pages. The first flush of an appended file only
+// fills up to the next page boundary, so later flushes stay page aligned.
+// Data reaches the file on flush(), when the buffer is full and on close().
+//
+// Writes are counted so the write amplification (pages touched per page
+// of data) of a sync can be reported with printStats().
+class FileSink : public Print
+{
+public:
+  FileSink();
+  ~FileSink();
+
+  // Open a file like LittleFS.open, only "w" and "a" make sense
+  bool open(const String &path, const char *mode);
+
+  // Flush and close the file
+  void close();
+
+  explicit operator bool() const { return (bool)file; }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t length) override;
+  using Print::write;
+
+  // Write the buffered data to the file
+  void flush() override;
+
+  // Whether a write to the file system has failed since open()
+  bool failed() const { return writeFailed; }
+
+  // Size of the file including the buffered data
+  size_t size() const { return position; }
+
+  // Free space in the buffer, for writers that fill it directly.
+  // Call commit() with the number of bytes placed at `space`.
+  size_t reserve(uint8_t *&space);
+  void commit(size_t length);
+
+  // The underlying file, flushed, for APIs that need a File or Stream
+  File &rawFile();
+
+  static const FileSinkStats &stats() { return totals; }
+  static void resetStats() { totals = FileSinkStats(); }
+  static void printStats(const char *label);
+
+private:
+  File file;
+  std::unique_ptr<uint8_t[]> buffer;
+  size_t bufferFill;
+  size_t bufferLimit; // Fill level that ends on a page boundary
+  size_t position;    // File offset of the end of the buffered data
+  bool writeFailed;
+
+  static FileSinkStats totals;
+};
+
+#endif // FILE_SINK_H
@@ -1,11 +1,9 @@
 #include "menuhandler.h"
 #include "filedownload.h"
+#include "recordstore.h"
 #include <Arduino.h>
 
-#define BASE_URL "https://raw.githubusercontent.com/BerndDA/CCY-VFD-7BT317NK/refs/heads/main/assets"
-#define DATA_FILENAME "/data.json"
-
-MenuHandler::MenuHandler() : jsonFilename(DATA_FILENAME), currentMenuIndex(0)
+MenuHandler::MenuHandler() : jsonFilename(DATA_FILENAME), currentMenuIndex(0), loaded(false)
 {
 }
 
@@ -21,7 +19,7 @@ bool MenuHandler::begin()
     // Check if JSON file exists, if not download it
     if (!LittleFS.exists(jsonFilename))
     {
-        String url = String(BASE_URL) + String(jsonFilename);
+        String url = String(ASSET_BASE_URL) + String(jsonFilename);
         FileDownloader downloader;
         if (!downloader.downloadFile(url.c_str(), jsonFilename))
         {
@@ -57,30 +55,99 @@ bool MenuHandler::parseJsonFile(JsonDocument &doc)
     return true;
 }
 
-void MenuHandler::loadMenuItems()
+bool MenuHandler::loadMenuItems()
 {
     JsonDocument doc;
 
     // Parse the JSON file
     if (!parseJsonFile(doc))
     {
-        return;
+        return false;
     }
 
+    // A reload replaces the items, the record stores close with them
+    menuItems.clear();
+    fileMenuItems.clear();
+
     for (JsonVariant item : doc.as<JsonArray>())
     {
         MenuItem menuItem = createMenuItemFromJson(item);
-        menuItems.push_back(menuItem);
-        if(menuItem.type == "file")
+        if (menuItem.type == "file")
+        {
+            menuItem.fileIndex = fileMenuItems.size();
             fileMenuItems.push_back(menuItem);
-        // Download the menu file if it doesn't exist
-        if (menuItem.type == "file" && !LittleFS.exists(menuItem.file))
+        }
+        menuItems.push_back(menuItem);
+        // Missing files are fetched in the background by AssetSyncService
+    }
+
+    // One record store per file item, opened on first use
+    recordStores.reset(new RecordStore[fileMenuItems.size()]);
+
+    // AssetSyncService ingests what it downloads; a text file left over
+    // from a failed ingest or an older firmware is ingested here, once per
+    // load instead of being looked up on every pick
+    for (const MenuItem &item : fileMenuItems)
+    {
+        if (LittleFS.exists(item.file))
+        {
+            RecordStore::ingest(item.file.c_str(), RecordStore::storeNameFor(item.file).c_str());
+        }
+    }
+
+    // The stores know how many records they hold, numrec in data.json can
+    // be behind (Kiwi appends, edited assets) and would size the shuffle
+    // wrongly
+    for (MenuItem &item : menuItems)
+    {
+        if (item.type != "file")
+        {
+            continue;
+        }
+        RecordStore &store = recordStores[item.fileIndex];
+        if (store.open(RecordStore::storeNameFor(item.file).c_str()))
+        {
+            item.numrec = store.count();
+            fileMenuItems[item.fileIndex].numrec = item.numrec;
+            store.close();
+        }
+    }
+
+    picker.begin(fileMenuItems);
+    return true;
+}
+
+bool MenuHandler::listAssetFiles(std::vector<String> &files)
+{
+    File jsonFile = LittleFS.open(DATA_FILENAME, "r");
+    if (!jsonFile)
+    {
+        Serial.printf("Failed to open JSON file %s for reading\n", DATA_FILENAME);
+        return false;
+    }
+
+    // Only the fields needed to derive file names
+    JsonDocument filter;
+    filter[0]["menu"] = true;
+    filter[0]["type"] = true;
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, jsonFile, DeserializationOption::Filter(filter));
+    jsonFile.close();
+    if (error)
+    {
+        Serial.printf("Failed to parse JSON: %s\n", error.c_str());
+        return false;
+    }
+
+    for (JsonVariant item : doc.as<JsonArray>())
+    {
+        if (item["type"] == "file" && item["menu"] != KIWI_MENU)
         {
-            String url = String(BASE_URL) + String("/") + menuItem.file;
-            FileDownloader downloader;
-            downloader.downloadFile(url.c_str(), menuItem.file.c_str());
+            files.push_back(item["menu"].as<String>() + ".txt");
         }
     }
+    return true;
 }
 
 MenuItem MenuHandler::createMenuItemFromJson(JsonVariant &item)
@@ -103,75 +170,63 @@ MenuItem MenuHandler::createMenuItemFromJson(JsonVariant &item)
     return menuItem;
 }
 
-String MenuHandler::getRandomRecord(const MenuItem &item)
+bool MenuHandler::getRandomRecord(const MenuItem &item, char *buffer, size_t size)
 {
+    buffer[0] = '\0';
+
     // If this is a special menu item without a file
     if (item.file.isEmpty() || item.numrec <= 0)
     {
-        return item.intro;
-    }
-
-    // Check if file exists
-    if (!LittleFS.exists(item.file))
-    {
-        Serial.printf("Output file %s not found\n", item.file.c_str());
-        return "";
+        return true;
     }
 
-    // Generate a random segment number between 1 and recordCount
-    int randomRecordNum = random(1, item.numrec + 1);
+    // Next record of the file's shuffled order, 1-based
+    int randomRecordNum = picker.next(item.fileIndex) + 1;
     Serial.printf("Randomly selected record #%d of %d for menu %s\n",
                   randomRecordNum, item.numrec, item.menu.c_str());
 
-    return readRecordFromFile(item, randomRecordNum);
+    return readRecordFromFile(item, randomRecordNum, buffer, size);
 }
 
-String MenuHandler::readRecordFromFile(const MenuItem &item, int recordNum)
+bool MenuHandler::readRecordFromFile(const MenuItem &item, int recordNum, char *buffer, size_t size)
 {
-    // Open the file for reading
+    // Stores stay open after the first read so later reads only seek
+    RecordStore &store = recordStores[item.fileIndex];
+    if (store.isOpen() || store.open(RecordStore::storeNameFor(item.file).c_str()))
+    {
+        // Records are stored transliterated, decode straight into the buffer
+        if (store.read(recordNum - 1, buffer, size) > 0)
+        {
+            return true;
+        }
+        Serial.printf("Record %d of %s unreadable\n", recordNum, item.file.c_str());
+    }
+
+    // Fall back to the plain text file if the store is missing or damaged
     File file = LittleFS.open(item.file, "r");
     if (!file)
     {
-        Serial.printf("Failed to open file %s for reading\n", item.file.c_str());
-        return "";
+        Serial.printf("Output file %s not found\n", item.file.c_str());
+        return false;
     }
 
-    String record = "";
-    int currentRecord = 0;
-
     // Read the file line by line (each line is a record)
-    while (file.available())
+    size_t length = 0;
+    for (int currentRecord = 1; file.available() && currentRecord <= recordNum; currentRecord++)
     {
-        String line = file.readStringUntil('\n');
-        currentRecord++;
-
-        if (currentRecord == recordNum)
-        {
-            record = line;
-            break;
-        }
+        length = file.readBytesUntil('\n', buffer, size - 1);
     }
-
+    buffer[length] = '\0';
     file.close();
 
     // Process the record text
-    record.trim();
-    record = replaceUmlautsAndSpecialChars(record);
-
-    return item.intro + "      " + record;
-}
+    while (length > 0 && isspace((uint8_t)buffer[length - 1]))
+    {
+        buffer[--length] = '\0';
+    }
+    RecordStore::transliterate(buffer, length);
 
-String MenuHandler::replaceUmlautsAndSpecialChars(const String &text)
-{
-    String result = text;
-    result.replace("ä", "ae");
-    result.replace("ö", "oe");
-    result.replace("ü", "ue");
-    result.replace("Ä", "Ae");
-    result.replace("Ö", "Oe");
-    result.replace("Ü", "Ue");
-    result.replace("ß", "ss");
-    return result;
+    return true;
 }
 
 // New methods for menu management
@@ -179,7 +234,7 @@ String MenuHandler::replaceUmlautsAndSpecialChars(const String &text)
 void MenuHandler::initializeMenuItems()
 {
     // Get the active menu items from JSON
-    loadMenuItems();
+    loaded = loadMenuItems();
 
     // Reset index to beginning
     currentMenuIndex = 0;
@@ -203,14 +258,15 @@ String MenuHandler::scrollToNextItem()
     return menuItems.at(currentMenuIndex).menu;
 }
 
-String MenuHandler::selectCurrentItem()
+const char *MenuHandler::selectCurrentItem(char *buffer, size_t size)
 {
     Serial.println("Select Menu Item");
 
     MenuItem* selectedItem = &menuItems.at(currentMenuIndex);
     if (selectedItem->type == "random")
     {
-        selectedItem = &fileMenuItems.at(random(0, fileMenuItems.size()));
+        // Bigger files are picked more often
+        selectedItem = &fileMenuItems.at(picker.pickFile());
     }
     else if (selectedItem->type != "file") // Check for spezial item
     {
@@ -219,11 +275,15 @@ String MenuHandler::selectCurrentItem()
         {
             specialActionCallback(selectedItem->type.c_str());
         }
-        return "";
+        return nullptr;
     }
 
     // Get a random record from the selected file menu item
-    return getRandomRecord(*selectedItem);
+    if (!getRandomRecord(*selectedItem, buffer, size))
+    {
+        return nullptr;
+    }
+    return selectedItem->intro.c_str();
 }
 
 void MenuHandler::setSpecialActionCallback(std::function<void(const char *item)> callback)
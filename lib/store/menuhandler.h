@@ -6,6 +6,18 @@
 #include <ArduinoJson.h>
 #include <vector>
 #include <functional>
+#include <memory>
+#include "recordstore.h"
+#include "recordpicker.h"
+
+// Override with -DASSET_BASE_URL='"http://<host>:8000"' to use asset_stub.py
+#ifndef ASSET_BASE_URL
+#define ASSET_BASE_URL "https://raw.githubusercontent.com/BerndDA/CCY-VFD-7BT317NK/refs/heads/main/assets"
+#endif
+#define DATA_FILENAME "/data.json"
+
+// Menu item whose records come from the Kiwi API, not from the asset host
+#define KIWI_MENU "kiwi"
 
 // Structure to hold menu item information
 struct MenuItem
@@ -15,6 +27,7 @@ struct MenuItem
   String file;  // Associated file
   int numrec;   // Number of records
   String type;  // Type of menu item
+  uint8_t fileIndex = 0; // Position among the file items
 };
 
 // Class for handling menu operations
@@ -26,20 +39,38 @@ public:
   // Initialize the menu handler
   bool begin();
 
-  // Get a random record from a specific menu item
-  String getRandomRecord(const MenuItem &item);
+  // Collect the record file names referenced by data.json that are
+  // hosted with the assets
+  static bool listAssetFiles(std::vector<String> &files);
+
+  // Decode a random record of a specific menu item into buffer
+  bool getRandomRecord(const MenuItem &item, char *buffer, size_t size);
+
+  // Write the record positions in batches (call periodically)
+  void updatePicker() { picker.update(); }
+
+  // Write unsaved record positions now, e.g. before a restart
+  void savePicker() { picker.save(); }
 
   // Get the current menu items list
   const std::vector<MenuItem> &getMenuItems() const;
 
-  // Initialize the menu items vector with special items
+  // Load the menu items from data.json, replacing any loaded before
   void initializeMenuItems();
 
+  // Whether the items are loaded and still match the assets
+  bool isLoaded() const { return loaded; }
+
+  // The assets changed, reload the items on the next initializeMenuItems()
+  void invalidate() { loaded = false; }
+
   // Scroll to the next menu item and return the new item's text
   String scrollToNextItem();
 
-  // Select and process the current menu item
-  String selectCurrentItem();
+  // Select and process the current menu item. The record is decoded
+  // into the caller's buffer; the returned intro stays owned by the
+  // handler. Returns nullptr if there is nothing to display.
+  const char *selectCurrentItem(char *buffer, size_t size);
 
   // Get current menu item index
   uint8_t getCurrentMenuIndex() const;
@@ -74,7 +105,10 @@ private:
   const char *jsonFilename;        // JSON filename
   std::vector<MenuItem> menuItems; // Menu items vector
   std::vector<MenuItem> fileMenuItems;
+  std::unique_ptr<RecordStore[]> recordStores; // Parallel to fileMenuItems
+  RecordPicker picker;                         // Shuffled record order
   uint8_t currentMenuIndex; // Current selected menu index
+  bool loaded;              // Items parsed from the current data.json
 
   std::function<void(const char *item)> specialActionCallback; // Callback for special actions
 
@@ -85,13 +119,10 @@ private:
   MenuItem createMenuItemFromJson(JsonVariant &item);
 
   // Read a specific record from a file
-  String readRecordFromFile(const MenuItem &item, int recordNum);
-
-  // Replace special characters with ASCII equivalents
-  String replaceUmlautsAndSpecialChars(const String &text);
+  bool readRecordFromFile(const MenuItem &item, int recordNum, char *buffer, size_t size);
 
   // Get all menu items that have at least one record
-  void loadMenuItems();
+  bool loadMenuItems();
 };
 
 #endif // MENU_HANDLER_H
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "recordpicker.h"
+#include "menuhandler.h"
+#include <algorithm>
+
+// Maximal-length Galois LFSR taps, indexed by register width
+static const uint16_t LFSR_TAPS[17] PROGMEM = {
+    0, 0, 0x3, 0x6, 0xC, 0x14, 0x30, 0x60, 0xB8,
+    0x110, 0x240, 0x500, 0xE08, 0x1C80, 0x3802, 0x6000, 0xD008};
+
+RecordPicker::RecordPicker()
+    : dirty(false),
+      dirtySince(0)
+{
+}
+
+void RecordPicker::begin(const std::vector<MenuItem> &files)
+{
+    // Keep the picks of the items being replaced, they are restored below
+    save();
+
+    slots.clear();
+    cumulativeWeights.clear();
+
+    uint32_t totalWeight = 0;
+    for (const MenuItem &item : files)
+    {
+        Slot slot;
+        slot.key = hashName(item.file);
+        slot.count = item.numrec > 0 ? min(item.numrec, 0xFFFF) : 0;
+        slot.state = 0;
+        slot.position = slot.count; // Forces a fresh cycle on first use
+        slots.push_back(slot);
+
+        totalWeight += slot.count;
+        cumulativeWeights.push_back(totalWeight);
+    }
+
+    // Restore positions of files whose record count did not change
+    File file = LittleFS.open(PICKER_STATE_FILENAME, "r");
+    if (!file)
+    {
+        return;
+    }
+
+    Slot saved;
+    while (file.read((uint8_t *)&saved, sizeof(saved)) == sizeof(saved))
+    {
+        for (Slot &slot : slots)
+        {
+            if (slot.key == saved.key && slot.count == saved.count)
+            {
+                slot = saved;
+                break;
+            }
+        }
+    }
+    file.close();
+}
+
+uint16_t RecordPicker::next(uint8_t fileIndex)
+{
+    if (fileIndex >= slots.size())
+    {
+        return 0;
+    }
+
+    Slot &slot = slots[fileIndex];
+    if (slot.count <= 1)
+    {
+        return 0;
+    }
+
+    if (slot.position >= slot.count || slot.state == 0)
+    {
+        startCycle(slot);
+    }
+
+    // Less than two steps on average, the register is at most twice the count
+    uint8_t width = widthFor(slot.count);
+    do
+    {
+        slot.state = step(slot.state, width);
+    } while (slot.state > slot.count);
+
+    slot.position++;
+    if (!dirty)
+    {
+        dirty = true;
+        dirtySince = millis();
+    }
+    return slot.state - 1;
+}
+
+uint8_t RecordPicker::pickFile() const
+{
+    if (cumulativeWeights.empty() || cumulativeWeights.back() == 0)
+    {
+        return slots.empty() ? 0 : random(0, slots.size());
+    }
+
+    uint32_t target = random(0, cumulativeWeights.back());
+    auto it = std::upper_bound(cumulativeWeights.begin(), cumulativeWeights.end(), target);
+    return it - cumulativeWeights.begin();
+}
+
+void RecordPicker::startCycle(Slot &slot)
+{
+    uint8_t width = widthFor(slot.count);
+    uint16_t last = slot.state;
+    uint16_t period = (1 << width) - 1;
+
+    // Random entry point into the sequence, but not one that would
+    // repeat the record shown last
+    for (uint8_t attempt = 0; attempt < 8; attempt++)
+    {
+        uint16_t start = random(1, period + 1);
+        uint16_t first = start;
+        do
+        {
+            first = step(first, width);
+        } while (first > slot.count);
+
+        slot.state = start;
+        if (first != last)
+        {
+            break;
+        }
+    }
+    slot.position = 0;
+}
+
+void RecordPicker::update()
+{
+    if (dirty && millis() - dirtySince >= SAVE_DELAY)
+    {
+        save();
+    }
+}
+
+void RecordPicker::save()
+{
+    if (!dirty)
+    {
+        return;
+    }
+    dirty = false;
+
+    File file = LittleFS.open(PICKER_STATE_FILENAME, "w");
+    if (!file)
+    {
+        Serial.println("Failed to save picker state");
+        return;
+    }
+    file.write((const uint8_t *)slots.data(), slots.size() * sizeof(Slot));
+    file.close();
+}
+
+uint8_t RecordPicker::widthFor(uint16_t count)
+{
+    uint8_t width = 2;
+    while (width < 16 && ((1UL << width) - 1) < count)
+    {
+        width++;
+    }
+    return width;
+}
+
+uint16_t RecordPicker::step(uint16_t state, uint8_t width)
+{
+    bool lsb = state & 1;
+    state >>= 1;
+    if (lsb)
+    {
+        state ^= pgm_read_word(&LFSR_TAPS[width]);
+    }
+    return state;
+}
+
+uint16_t RecordPicker::hashName(const String &name)
+{
+    // FNV-1a folded to 16 bits
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < name.length(); i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619UL;
+    }
+    return (hash >> 16) ^ (hash & 0xFFFF);
+}
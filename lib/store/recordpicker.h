@@ -0,0 +1,68 @@
+#ifndef RECORD_PICKER_H
+#define RECORD_PICKER_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <vector>
+
+#define PICKER_STATE_FILENAME "/picker.bin"
+
+struct MenuItem;
+
+// Random record selection without repeats
+//
+// Each file walks a shuffled permutation of its records, produced by a
+// maximal-length Galois LFSR that is just wide enough for the record
+// count; outputs above the count are skipped. Only the LFSR register and
+// the position in the current cycle are kept per file, and they are
+// persisted so the no-repeat guarantee survives reboots. Picks are
+// written in batches by update(): a power cut in between can repeat the
+// records of the last few minutes, nothing worse. A new cycle
+// starts from a random register and never opens with the record that
+// closed the previous one.
+//
+// Files for the "random" menu entry are weighted by their record count.
+class RecordPicker
+{
+public:
+  RecordPicker();
+
+  // Bind to the file menu items and restore the saved positions
+  void begin(const std::vector<MenuItem> &files);
+
+  // Next record (0-based) of file `fileIndex`
+  uint16_t next(uint8_t fileIndex);
+
+  // A file index, chosen with probability proportional to its records
+  uint8_t pickFile() const;
+
+  // Write the positions once SAVE_DELAY has passed since the first
+  // unsaved pick (call periodically)
+  void update();
+
+  // Write unsaved positions now, e.g. before a restart
+  void save();
+
+private:
+  struct Slot
+  {
+    uint16_t key;      // Hash of the file name
+    uint16_t count;    // Records in the permutation
+    uint16_t state;    // LFSR register, also the last record + 1
+    uint16_t position; // Records handed out in this cycle
+  };
+
+  std::vector<Slot> slots;
+  std::vector<uint32_t> cumulativeWeights;
+  bool dirty;                 // Picks not written yet
+  unsigned long dirtySince;   // Time of the first of them
+  static constexpr unsigned long SAVE_DELAY = 5 * 60 * 1000UL; // 5 minutes
+
+  void startCycle(Slot &slot);
+
+  static uint8_t widthFor(uint16_t count);
+  static uint16_t step(uint16_t state, uint8_t width);
+  static uint16_t hashName(const String &name);
+};
+
+#endif // RECORD_PICKER_H
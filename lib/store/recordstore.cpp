@@ -0,0 +1,450 @@
+#include "recordstore.h"
+
+// Frequent German fragments, indexed by code - 0x81. Picked so the
+// shipped assets shrink by roughly a third; longer words gain little
+// because most records are short sentences.
+static const char DICTIONARY[127][6] PROGMEM = {
+    " der ", " die ", " und ", " das ", " ist ", " ein", " ich ", " nic",
+    "nicht", " sie ", " mit ", " auf ", " den ", " es ", " zu ", "sch",
+    "ich", "ein", "cht", "che", "ung", "en ", "er ", "ie ",
+    "te ", "es ", "st ", "ge", "be", "ver", " wir", " du ",
+    "n, ", ". ", ", ", "er", "en", "ch", "ei", "ie",
+    "in", "te", "nd", "un", "st", "an", "re", "de",
+    "ne", "it", "es", "he", "ar", "se", "ra", "ss",
+    "au", "li", "tz", "ma", "ha", "al", "on", "ll",
+    "or", "ti", "is", "ri", "mi", "ab", "em", "ur",
+    "el", "ns", "si", "ta", "ck", "Die ", "Das ", "Der ",
+    "Es ", "Ich ", "Wir ", "Was ", "Wenn ", "Und ", " nur ", " noch",
+    " so ", " wie ", " als ", " aus ", " im ", " in ", " hat", " man ",
+    " dann", " aber", " auch", " wird", " kann", " sind", " von", " dem",
+    " mal", " mehr", " sein", " zum", " bei", "eit", "ach", "lich",
+    "ten", "gen", "ter", "ben", "der", "den", "ber", "ier",
+    "mme", "ll ", "uns", "ist", " fue", "ert", "ehr",
+};
+
+#define CODE_ESCAPE 0x80
+#define CODE_FIRST_ENTRY 0x81
+
+RecordStore::RecordStore() : recordCount(0)
+{
+}
+
+RecordStore::~RecordStore()
+{
+    close();
+}
+
+bool RecordStore::open(const char *storeFile)
+{
+    close();
+
+    file = LittleFS.open(storeFile, "r");
+    if (!file)
+    {
+        return false;
+    }
+
+    Header header;
+    if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        memcmp(header.magic, "VRS1", 4) != 0)
+    {
+        Serial.printf("Invalid record store %s\n", storeFile);
+        close();
+        return false;
+    }
+
+    recordCount = header.count;
+    return true;
+}
+
+void RecordStore::close()
+{
+    if (file)
+    {
+        file.close();
+    }
+    recordCount = 0;
+}
+
+size_t RecordStore::read(uint16_t index, char *out, size_t outSize)
+{
+    if (outSize == 0)
+    {
+        return 0;
+    }
+    out[0] = '\0';
+
+    if (!file || index >= recordCount)
+    {
+        return 0;
+    }
+
+    // Start and end offset of the record
+    uint32_t range[2];
+    if (!file.seek(sizeof(Header) + index * sizeof(uint32_t)) ||
+        file.read((uint8_t *)range, sizeof(range)) != sizeof(range) || range[1] < range[0])
+    {
+        return 0;
+    }
+
+    // A store cut short ends before the record
+    size_t dataStart = sizeof(Header) + (recordCount + 1) * sizeof(uint32_t);
+    if (dataStart + range[1] > file.size() || !file.seek(dataStart + range[0]))
+    {
+        return 0;
+    }
+
+    size_t remaining = range[1] - range[0];
+    size_t length = 0;
+    bool escape = false;
+    uint8_t chunk[64];
+
+    while (remaining > 0 && length < outSize - 1)
+    {
+        size_t bytesRead = file.read(chunk, min(remaining, sizeof(chunk)));
+        if (bytesRead == 0)
+        {
+            break;
+        }
+        remaining -= bytesRead;
+
+        for (size_t i = 0; i < bytesRead && length < outSize - 1; i++)
+        {
+            uint8_t code = chunk[i];
+            if (escape || code < CODE_ESCAPE)
+            {
+                out[length++] = code;
+                escape = false;
+            }
+            else if (code == CODE_ESCAPE)
+            {
+                escape = true;
+            }
+            else
+            {
+                const char *entry = DICTIONARY[code - CODE_FIRST_ENTRY];
+                for (uint8_t j = 0; j < sizeof(DICTIONARY[0]) && length < outSize - 1; j++)
+                {
+                    char c = pgm_read_byte(entry + j);
+                    if (c == '\0')
+                    {
+                        break;
+                    }
+                    out[length++] = c;
+                }
+            }
+        }
+    }
+
+    out[length] = '\0';
+    return length;
+}
+
+size_t RecordStore::compress(const char *in, size_t length, uint8_t *out)
+{
+    size_t outPos = 0;
+    size_t pos = 0;
+
+    while (pos < length)
+    {
+        // Greedy longest dictionary match
+        int bestEntry = -1;
+        size_t bestLength = 1;
+        for (size_t entry = 0; entry < sizeof(DICTIONARY) / sizeof(DICTIONARY[0]); entry++)
+        {
+            size_t entryLength = strlen_P(DICTIONARY[entry]);
+            if (entryLength > bestLength && entryLength <= length - pos &&
+                strncmp_P(in + pos, DICTIONARY[entry], entryLength) == 0)
+            {
+                bestEntry = entry;
+                bestLength = entryLength;
+            }
+        }
+
+        if (bestEntry >= 0)
+        {
+            out[outPos++] = CODE_FIRST_ENTRY + bestEntry;
+            pos += bestLength;
+        }
+        else
+        {
+            uint8_t c = in[pos++];
+            if (c >= CODE_ESCAPE)
+            {
+                out[outPos++] = CODE_ESCAPE;
+            }
+            out[outPos++] = c;
+        }
+    }
+
+    return outPos;
+}
+
+void RecordStore::transliterate(char *text, size_t length)
+{
+    for (size_t i = 0; i + 1 < length; i++)
+    {
+        if ((uint8_t)text[i] != 0xC3)
+        {
+            continue;
+        }
+
+        const char *ascii = nullptr;
+        switch ((uint8_t)text[i + 1])
+        {
+        case 0xA4: ascii = "ae"; break; // ä
+        case 0xB6: ascii = "oe"; break; // ö
+        case 0xBC: ascii = "ue"; break; // ü
+        case 0x84: ascii = "Ae"; break; // Ä
+        case 0x96: ascii = "Oe"; break; // Ö
+        case 0x9C: ascii = "Ue"; break; // Ü
+        case 0x9F: ascii = "ss"; break; // ß
+        }
+
+        if (ascii)
+        {
+            text[i] = ascii[0];
+            text[i + 1] = ascii[1];
+            i++;
+        }
+    }
+}
+
+// Scratch for ingest() and append(), which never run at the same time.
+// Static to keep them off the 4 KB stack; worst case every byte is escaped.
+static char line[RECORD_MAX_LENGTH + 1];
+static uint8_t packed[RECORD_MAX_LENGTH * 2];
+
+// Records compressed between two yields. Compressing one costs up to a
+// dictionary scan per character, a large file would trip the watchdog.
+#define INGEST_YIELD_RECORDS 16
+
+static void yieldEvery(uint32_t record)
+{
+    if (record % INGEST_YIELD_RECORDS == INGEST_YIELD_RECORDS - 1)
+    {
+        yield();
+    }
+}
+
+// Read one line, strip the line break and surrounding whitespace
+static size_t readRecordLine(File &text, char *line, size_t size)
+{
+    size_t length = text.readBytesUntil('\n', line, size - 1);
+    line[length] = '\0';
+
+    while (length > 0 && isspace((uint8_t)line[length - 1]))
+    {
+        line[--length] = '\0';
+    }
+
+    size_t start = 0;
+    while (start < length && isspace((uint8_t)line[start]))
+    {
+        start++;
+    }
+    if (start > 0)
+    {
+        memmove(line, line + start, length - start + 1);
+        length -= start;
+    }
+
+    RecordStore::transliterate(line, length);
+    return length;
+}
+
+bool RecordStore::ingest(const char *textFile, const char *storeFile)
+{
+    File text = LittleFS.open(textFile, "r");
+    if (!text)
+    {
+        Serial.printf("Failed to open %s for ingest\n", textFile);
+        return false;
+    }
+
+    // Pass 1: count records
+    uint32_t count = 0;
+    while (text.available() && count < 0xFFFF)
+    {
+        readRecordLine(text, line, sizeof(line));
+        yieldEvery(count++);
+    }
+
+    // The many small index and record writes are combined by the sink
+    String tmpFilename = String(storeFile) + ".tmp";
+    FileSink store;
+    if (!store.open(tmpFilename, "w"))
+    {
+        Serial.printf("Failed to open %s for writing\n", tmpFilename.c_str());
+        text.close();
+        return false;
+    }
+
+    Header header = {{'V', 'R', 'S', '1'}, (uint16_t)count, 0};
+    bool ok = store.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+
+    // Pass 2: index of end offsets, starting with 0
+    uint32_t offset = 0;
+    ok = ok && store.write((const uint8_t *)&offset, sizeof(offset)) == sizeof(offset);
+    text.seek(0);
+    for (uint32_t i = 0; i < count && ok; i++)
+    {
+        size_t length = readRecordLine(text, line, sizeof(line));
+        offset += compress(line, length, packed);
+        yieldEvery(i);
+        ok = store.write((const uint8_t *)&offset, sizeof(offset)) == sizeof(offset);
+    }
+
+    // Pass 3: compressed data
+    text.seek(0);
+    for (uint32_t i = 0; i < count && ok; i++)
+    {
+        size_t length = readRecordLine(text, line, sizeof(line));
+        size_t packedLength = compress(line, length, packed);
+        yieldEvery(i);
+        ok = store.write(packed, packedLength) == packedLength;
+    }
+
+    size_t textSize = text.size();
+    size_t storeSize = store.size();
+    text.close();
+    store.close();
+    ok = ok && !store.failed();
+
+    if (!ok || !LittleFS.rename(tmpFilename, storeFile))
+    {
+        Serial.printf("Failed to ingest %s\n", textFile);
+        LittleFS.remove(tmpFilename);
+        return false;
+    }
+
+    // The text file is no longer needed, its records live in the store now
+    LittleFS.remove(textFile);
+    Serial.printf("Ingested %u records from %s: %u -> %u bytes\n",
+                  count, textFile, textSize, storeSize);
+    return true;
+}
+
+// Copy `length` bytes from the current position of one file to another
+static bool copyBytes(File &from, FileSink &to, size_t length, uint8_t *buffer, size_t bufferSize)
+{
+    while (length > 0)
+    {
+        size_t chunk = from.read(buffer, min(length, bufferSize));
+        if (chunk == 0 || to.write(buffer, chunk) != chunk)
+        {
+            return false;
+        }
+        length -= chunk;
+    }
+    return true;
+}
+
+bool RecordStore::append(const char *textFile, const char *storeFile)
+{
+    if (!LittleFS.exists(storeFile))
+    {
+        return ingest(textFile, storeFile);
+    }
+
+    File old = LittleFS.open(storeFile, "r");
+    Header oldHeader;
+    if (!old || old.read((uint8_t *)&oldHeader, sizeof(oldHeader)) != sizeof(oldHeader) ||
+        memcmp(oldHeader.magic, "VRS1", 4) != 0)
+    {
+        Serial.printf("Invalid record store %s, cannot append\n", storeFile);
+        return false;
+    }
+
+    File text = LittleFS.open(textFile, "r");
+    if (!text)
+    {
+        Serial.printf("Failed to open %s for append\n", textFile);
+        old.close();
+        return false;
+    }
+
+    // Pass 1: count new records
+    uint32_t added = 0;
+    while (text.available() && oldHeader.count + added < 0xFFFF)
+    {
+        readRecordLine(text, line, sizeof(line));
+        yieldEvery(added++);
+    }
+
+    if (added == 0)
+    {
+        text.close();
+        old.close();
+        LittleFS.remove(textFile);
+        return true;
+    }
+
+    // End offset of the existing data, the last index entry
+    uint32_t oldDataLength = 0;
+    old.seek(sizeof(Header) + oldHeader.count * sizeof(uint32_t));
+    old.read((uint8_t *)&oldDataLength, sizeof(oldDataLength));
+
+    String tmpFilename = String(storeFile) + ".tmp";
+    FileSink store;
+    if (!store.open(tmpFilename, "w"))
+    {
+        Serial.printf("Failed to open %s for writing\n", tmpFilename.c_str());
+        text.close();
+        old.close();
+        return false;
+    }
+
+    uint32_t count = oldHeader.count + added;
+    Header header = {{'V', 'R', 'S', '1'}, (uint16_t)count, 0};
+    bool ok = store.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+
+    // Existing index as is, then the new end offsets
+    old.seek(sizeof(Header));
+    ok = ok && copyBytes(old, store, (oldHeader.count + 1) * sizeof(uint32_t), packed, sizeof(packed));
+    uint32_t offset = oldDataLength;
+    text.seek(0);
+    for (uint32_t i = 0; i < added && ok; i++)
+    {
+        size_t length = readRecordLine(text, line, sizeof(line));
+        offset += compress(line, length, packed);
+        yieldEvery(i);
+        ok = store.write((const uint8_t *)&offset, sizeof(offset)) == sizeof(offset);
+    }
+
+    // Existing data as is, then the new records
+    ok = ok && copyBytes(old, store, oldDataLength, packed, sizeof(packed));
+    text.seek(0);
+    for (uint32_t i = 0; i < added && ok; i++)
+    {
+        size_t length = readRecordLine(text, line, sizeof(line));
+        size_t packedLength = compress(line, length, packed);
+        yieldEvery(i);
+        ok = store.write(packed, packedLength) == packedLength;
+    }
+
+    size_t storeSize = store.size();
+    text.close();
+    old.close();
+    store.close();
+    ok = ok && !store.failed();
+
+    if (!ok || !LittleFS.rename(tmpFilename, storeFile))
+    {
+        Serial.printf("Failed to append %s\n", textFile);
+        LittleFS.remove(tmpFilename);
+        return false;
+    }
+
+    LittleFS.remove(textFile);
+    Serial.printf("Appended %u records from %s, %u in store, %u bytes\n",
+                  added, textFile, count, storeSize);
+    return true;
+}
+
+String RecordStore::storeNameFor(const String &textFile)
+{
+    int dot = textFile.lastIndexOf('.');
+    String base = dot >= 0 ? textFile.substring(0, dot) : textFile;
+    return base + ".rec";
+}
@@ -0,0 +1,74 @@
+#ifndef RECORD_STORE_H
+#define RECORD_STORE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "filesink.h"
+
+// Longest record handled by ingest and read, in decoded characters
+#define RECORD_MAX_LENGTH 1024
+
+// Compressed, indexed storage for the line based text assets
+//
+// Layout of a store file:
+//   header   "VRS1", uint16 record count, uint16 reserved
+//   index    (count + 1) uint32 offsets into the data section
+//   data     compressed records, back to back
+//
+// Records are transliterated to ASCII once at ingest time and encoded
+// with a static dictionary: bytes below 0x80 are literals, 0x80 escapes
+// the next byte and 0x81..0xFF stand for one dictionary entry. Every
+// record decodes on its own, so reading one is a seek plus a short read.
+class RecordStore
+{
+public:
+  RecordStore();
+  ~RecordStore();
+
+  // Open a store for reading
+  bool open(const char *storeFile);
+
+  // Close the store file
+  void close();
+
+  // Whether a store is open
+  bool isOpen() const { return (bool)file; }
+
+  // Number of records in the open store
+  uint16_t count() const { return recordCount; }
+
+  // Decode record `index` (0-based) into `out` and NUL-terminate it.
+  // Returns the decoded length, 0 if the record does not exist or the
+  // store is damaged.
+  size_t read(uint16_t index, char *out, size_t outSize);
+
+  // Convert a newline separated text file into a store file
+  static bool ingest(const char *textFile, const char *storeFile);
+
+  // Add the records of a text file after those already in a store.
+  // Existing records are copied without recompressing them; a missing
+  // store is created as by ingest.
+  static bool append(const char *textFile, const char *storeFile);
+
+  // Store file name that belongs to a text asset ("po.txt" -> "po.rec")
+  static String storeNameFor(const String &textFile);
+
+  // Replace UTF-8 umlauts and sharp s by their ASCII spelling in place.
+  // Every replacement is two bytes for two bytes, so the length is kept.
+  static void transliterate(char *text, size_t length);
+
+private:
+  struct Header
+  {
+    char magic[4];
+    uint16_t count;
+    uint16_t reserved;
+  };
+
+  File file;
+  uint16_t recordCount;
+
+  static size_t compress(const char *in, size_t length, uint8_t *out);
+};
+
+#endif // RECORD_STORE_H
@@ -0,0 +1,230 @@
+#include "responsecache.h"
+
+static const char INDEX_FILE[] = RESPONSE_CACHE_DIR "/index";
+static const char TMP_FILE[] = RESPONSE_CACHE_DIR "/response.tmp";
+
+ResponseCache::ResponseCache() : entryCount(0), totalSize(0), clock(0)
+{
+}
+
+bool ResponseCache::begin()
+{
+    entryCount = 0;
+    totalSize = 0;
+    clock = 0;
+
+    File index = LittleFS.open(INDEX_FILE, "r");
+    if (index)
+    {
+        Header header;
+        if (index.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+            memcmp(header.magic, "VRC1", 4) == 0)
+        {
+            clock = header.clock;
+            uint16_t count = header.count < RESPONSE_CACHE_ENTRIES ? header.count : RESPONSE_CACHE_ENTRIES;
+            for (uint16_t i = 0; i < count; i++)
+            {
+                Entry &entry = entries[entryCount];
+                if (index.read((uint8_t *)&entry, sizeof(entry)) != sizeof(entry))
+                {
+                    break;
+                }
+                // A put that was cut short may leave a stale entry
+                if (LittleFS.exists(pathFor(entry.hash)))
+                {
+                    totalSize += entry.size;
+                    entryCount++;
+                }
+            }
+        }
+        else
+        {
+            Serial.println("Invalid response cache index, starting empty");
+        }
+        index.close();
+    }
+
+    removeOrphans();
+    Serial.printf("Response cache: %u entries, %u bytes\n", entryCount, totalSize);
+    return true;
+}
+
+size_t ResponseCache::get(const char *prompt, char *out, size_t outSize)
+{
+    int i = find(hashPrompt(prompt));
+    if (i < 0 || outSize == 0)
+    {
+        return 0;
+    }
+
+    File file = LittleFS.open(pathFor(entries[i].hash), "r");
+    if (!file)
+    {
+        removeAt(i);
+        saveIndex();
+        return 0;
+    }
+    size_t length = file.read((uint8_t *)out, outSize - 1);
+    file.close();
+    out[length] = '\0';
+
+    // Written to flash with the next change
+    entries[i].lastUsed = ++clock;
+    return length;
+}
+
+bool ResponseCache::contains(const char *prompt) const
+{
+    return find(hashPrompt(prompt)) >= 0;
+}
+
+bool ResponseCache::put(const char *prompt, const char *response, size_t length)
+{
+    if (length == 0 || length > RESPONSE_CACHE_BYTES)
+    {
+        return false;
+    }
+
+    uint32_t hash = hashPrompt(prompt);
+    int i = find(hash);
+    if (i >= 0)
+    {
+        removeAt(i);
+    }
+    evictFor(length);
+
+    // Write aside first, an interrupted write leaves the old response
+    File file = LittleFS.open(TMP_FILE, "w");
+    bool ok = file && file.write((const uint8_t *)response, length) == length;
+    if (file)
+    {
+        file.close();
+    }
+    if (!ok || !LittleFS.rename(TMP_FILE, pathFor(hash)))
+    {
+        Serial.println("Failed to write response cache entry");
+        LittleFS.remove(TMP_FILE);
+        saveIndex();
+        return false;
+    }
+
+    Entry &entry = entries[entryCount++];
+    entry.hash = hash;
+    entry.lastUsed = ++clock;
+    entry.size = length;
+    entry.reserved = 0;
+    totalSize += length;
+    return saveIndex();
+}
+
+void ResponseCache::remove(const char *prompt)
+{
+    int i = find(hashPrompt(prompt));
+    if (i >= 0)
+    {
+        LittleFS.remove(pathFor(entries[i].hash));
+        removeAt(i);
+        saveIndex();
+    }
+}
+
+// FNV-1a, as used for the Kiwi content hash
+uint32_t ResponseCache::hashPrompt(const char *prompt)
+{
+    uint32_t hash = 2166136261u;
+    for (; *prompt; prompt++)
+    {
+        hash = (hash ^ (uint8_t)*prompt) * 16777619u;
+    }
+    return hash;
+}
+
+int ResponseCache::find(uint32_t hash) const
+{
+    for (uint16_t i = 0; i < entryCount; i++)
+    {
+        if (entries[i].hash == hash)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Drop an index entry, the file is left to the caller
+void ResponseCache::removeAt(int index)
+{
+    totalSize -= entries[index].size;
+    entries[index] = entries[--entryCount];
+}
+
+// Remove least recently used responses until `length` more bytes fit
+void ResponseCache::evictFor(size_t length)
+{
+    while (entryCount > 0 &&
+           (entryCount >= RESPONSE_CACHE_ENTRIES || totalSize + length > RESPONSE_CACHE_BYTES))
+    {
+        int oldest = 0;
+        for (uint16_t i = 1; i < entryCount; i++)
+        {
+            if (entries[i].lastUsed < entries[oldest].lastUsed)
+            {
+                oldest = i;
+            }
+        }
+        Serial.printf("Response cache: evicting %08x\n", entries[oldest].hash);
+        LittleFS.remove(pathFor(entries[oldest].hash));
+        removeAt(oldest);
+    }
+}
+
+bool ResponseCache::saveIndex()
+{
+    File index = LittleFS.open(INDEX_FILE, "w");
+    if (!index)
+    {
+        Serial.println("Failed to write response cache index");
+        return false;
+    }
+
+    Header header = {{'V', 'R', 'C', '1'}, entryCount, 0, clock};
+    size_t length = sizeof(Entry) * entryCount;
+    bool ok = index.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              index.write((const uint8_t *)entries, length) == length;
+    index.close();
+    return ok;
+}
+
+// Remove response files the index does not know. The scan starts over
+// after each removal rather than changing the directory under it.
+void ResponseCache::removeOrphans()
+{
+    bool removed;
+    do
+    {
+        removed = false;
+        Dir dir = LittleFS.openDir(RESPONSE_CACHE_DIR);
+        while (dir.next())
+        {
+            String name = dir.fileName();
+            if (name == "index")
+            {
+                continue;
+            }
+            uint32_t hash = strtoul(name.c_str(), nullptr, 16);
+            if (name.length() != 8 || find(hash) < 0)
+            {
+                Serial.printf("Response cache: removing %s\n", name.c_str());
+                removed = LittleFS.remove(String(RESPONSE_CACHE_DIR "/") + name);
+                break;
+            }
+        }
+    } while (removed);
+}
+
+String ResponseCache::pathFor(uint32_t hash)
+{
+    char path[sizeof(RESPONSE_CACHE_DIR) + 10];
+    snprintf(path, sizeof(path), RESPONSE_CACHE_DIR "/%08x", hash);
+    return String(path);
+}
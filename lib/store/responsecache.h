@@ -0,0 +1,84 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+// Responses kept, and the bytes they may take together
+#define RESPONSE_CACHE_ENTRIES 16
+#define RESPONSE_CACHE_BYTES (16 * 1024)
+
+// Directory of the cache files
+#define RESPONSE_CACHE_DIR "/cache"
+
+// Recent responses of slow remote services, kept in LittleFS
+//
+// Each response is stored in its own file, named after the FNV-1a hash
+// of the prompt that produced it. The index file lists the hashes with
+// their sizes and a use counter; when a new response does not fit in
+// RESPONSE_CACHE_ENTRIES or RESPONSE_CACHE_BYTES, the least recently
+// used ones are removed first.
+//
+// A lookup only bumps the use counter in RAM, the index is written with
+// the next put() or remove(), so reading the cache costs no flash writes.
+// Files without an index entry (an interrupted put) are removed by
+// begin().
+class ResponseCache
+{
+public:
+  ResponseCache();
+
+  // Load the index, dropping entries whose file is gone
+  bool begin();
+
+  // Copy the response for `prompt` into `out` and NUL-terminate it.
+  // Returns the response length, 0 if it is not cached.
+  size_t get(const char *prompt, char *out, size_t outSize);
+
+  // Whether a response for `prompt` is cached
+  bool contains(const char *prompt) const;
+
+  // Store or replace the response for `prompt`
+  bool put(const char *prompt, const char *response, size_t length);
+
+  // Forget the response for `prompt`
+  void remove(const char *prompt);
+
+  // Number of cached responses and their total size
+  uint16_t count() const { return entryCount; }
+  uint32_t size() const { return totalSize; }
+
+  static uint32_t hashPrompt(const char *prompt);
+
+private:
+  struct Header
+  {
+    char magic[4];
+    uint16_t count;
+    uint16_t reserved;
+    uint32_t clock;
+  };
+
+  struct Entry
+  {
+    uint32_t hash;
+    uint32_t lastUsed; // Value of clock at the last get or put
+    uint16_t size;
+    uint16_t reserved;
+  };
+
+  Entry entries[RESPONSE_CACHE_ENTRIES];
+  uint16_t entryCount;
+  uint32_t totalSize;
+  uint32_t clock;
+
+  int find(uint32_t hash) const;
+  void removeAt(int index);
+  void evictFor(size_t length);
+  bool saveIndex();
+  void removeOrphans();
+
+  static String pathFor(uint32_t hash);
+};
+
+#endif // RESPONSE_CACHE_H
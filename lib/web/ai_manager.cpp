@@ -2,10 +2,112 @@
 #include "animator.h"
 #include "gui.h"
 
+// Bytes handled per process() call, keeps the main loop responsive
+static const size_t AI_READ_SLICE = 256;
+
+// Request bytes collected per socket write, each write is a TLS record
+static const size_t AI_WRITE_BUFFER = 256;
+
+// Collects small prints into larger socket writes
+class SocketWriter : public Print
+{
+public:
+    explicit SocketWriter(Client &client) : _client(client) {}
+    ~SocketWriter() { flush(); }
+
+    size_t write(uint8_t c) override
+    {
+        if (_fill == sizeof(_buffer))
+        {
+            flush();
+        }
+        _buffer[_fill++] = c;
+        return 1;
+    }
+
+    size_t write(const uint8_t *data, size_t length) override
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            write(data[i]);
+        }
+        return length;
+    }
+
+    void flush() override
+    {
+        if (_fill > 0)
+        {
+            _client.write(_buffer, _fill);
+            _fill = 0;
+        }
+    }
+
+private:
+    Client &_client;
+    uint8_t _buffer[AI_WRITE_BUFFER];
+    size_t _fill = 0;
+};
+
+// Counts what would be written, for Content-Length
+class LengthCounter : public Print
+{
+public:
+    size_t write(uint8_t) override
+    {
+        length++;
+        return 1;
+    }
+
+    size_t write(const uint8_t *, size_t count) override
+    {
+        length += count;
+        return count;
+    }
+
+    size_t length = 0;
+};
+
+// Write a JSON string literal with quotes and escapes
+static void writeJsonString(Print &out, const char *text)
+{
+    out.write('"');
+    for (; *text; text++)
+    {
+        uint8_t c = *text;
+        if (c == '"' || c == '\\')
+        {
+            out.write('\\');
+            out.write(c);
+        }
+        else if (c < 0x20)
+        {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out.print(escaped);
+        }
+        else
+        {
+            out.write(c);
+        }
+    }
+    out.write('"');
+}
+
+// German umlauts in UTF-8 (after the 0xC3 lead byte) and their spelling
+static const struct
+{
+    uint8_t trail;
+    char replacement[3];
+} UMLAUTS[] = {
+    {0xA4, "ae"}, {0xB6, "oe"}, {0xBC, "ue"}, {0x84, "Ae"}, {0x96, "Oe"}, {0x9C, "Ue"}, {0x9F, "ss"}};
+
 // Constructor
 AiManager::AiManager(Animator *animator, const char *apiKey, const char *assistantId)
     : _animator(animator), _apiKey(apiKey), _assistantId(assistantId)
 {
+    _event[0] = '\0';
+    _reply[0] = '\0';
 }
 
 // Destructor
@@ -24,17 +126,26 @@ bool AiManager::isActive() const
     return _state != State::IDLE && _state != State::COMPLETE && _state != State::ERROR;
 }
 
-void AiManager::onComplete(void (*callback)(const String &message))
+void AiManager::setEndpoint(const char *host, uint16_t port, bool secure)
+{
+    _host = host;
+    _port = port;
+    _secure = secure;
+    _plainClient.reset();
+    _client = nullptr;
+}
+
+void AiManager::onComplete(std::function<void(const String &message)> callback)
 {
     _completeCallback = callback;
 }
 
-void AiManager::onError(void (*callback)(const String &errorMessage))
+void AiManager::onError(std::function<void(const String &errorMessage)> callback)
 {
     _errorCallback = callback;
 }
 
-void AiManager::startConversation(const char *prompt)
+void AiManager::startConversation(const char *prompt, bool show)
 {
     if (isActive())
     {
@@ -42,16 +153,35 @@ void AiManager::startConversation(const char *prompt)
     }
 
     _prompt = prompt;
-    vfd_gui_set_text(" denke");
-    _animator->start_loading(0x01);
+    _show = show;
+    if (_show)
+    {
+        vfd_gui_set_text(" denke");
+        _animator->start_loading(0x01);
+    }
     _stateStartTime = millis();
+    _state = State::SEND_REQUEST;
+}
 
-    // Initialize HTTP client
-    _client = new WiFiClientSecure();
-    _http = new HTTPClient();
-    _client->setInsecure(); // Only for development
-    _doc = new JsonDocument();
-    _state = State::CREATE_THREAD;
+bool AiManager::connect()
+{
+    if (_secure)
+    {
+        _client = TlsPool::connect(_host.c_str(), _port, this, &_reusedConnection);
+        return _client != nullptr;
+    }
+
+    _reusedConnection = _plainClient && _plainClient->connected();
+    if (!_reusedConnection)
+    {
+        _plainClient.reset(new WiFiClient());
+        if (!_plainClient->connect(_host.c_str(), _port))
+        {
+            return false;
+        }
+    }
+    _client = _plainClient.get();
+    return true;
 }
 
 void AiManager::process()
@@ -69,223 +199,577 @@ void AiManager::process()
         return;
     }
 
-    // Constants for API endpoints
-    const char *BASE_URL = "https://api.openai.com/v1";
-
     // State machine
     switch (_state)
     {
-    case State::CREATE_THREAD:
+    case State::SEND_REQUEST:
     {
-        _http->useHTTP10(true);
-        _http->begin(*_client, String(BASE_URL) + "/threads");
-        setHeaders();
-
-        int httpResponseCode = _http->POST("{}");
-        if (httpResponseCode <= 0)
+        if (!connect())
         {
-            handleError("Error creating thread: " + String(httpResponseCode));
+            handleError("Error connecting to " + _host);
             return;
         }
 
-        // Parse thread ID
-        JsonDocument idFilter;
-        idFilter["id"] = true;
-        deserializeJson(*_doc, _http->getStream(), DeserializationOption::Filter(idFilter));
-        _threadId = (*_doc)["id"].as<String>();
-        Serial.println("Thread ID: " + _threadId);
-        _http->end();
-
-        _state = State::ADD_MESSAGE;
+        sendRequest();
+
+        _lineLength = 0;
+        _httpCode = 0;
+        _keepAlive = true;
+        _body = Body::IDENTITY;
+        _field = Field::NAME;
+        _lineEmpty = true;
+        _event[0] = '\0';
+        _runCompleted = false;
+        _utf8Lead = 0;
+        _replyLength = 0;
+        _shownLength = 0;
+        _reply[0] = '\0';
+        _state = State::READ_HEADERS;
         break;
     }
 
-    case State::ADD_MESSAGE:
+    case State::READ_HEADERS:
+    case State::STREAM:
     {
-        _http->begin(*_client, String(BASE_URL) + "/threads/" + _threadId + "/messages");
-        setHeaders();
+        if (_secure && !TlsPool::isOpen(_client))
+        {
+            // Closed under us, e.g. by a newly pinned key
+            _client = nullptr;
+            handleError("AI connection lost");
+            return;
+        }
 
-        String messageJson = "{\"role\":\"user\",\"content\":\"" + _prompt + "\"}";
-        int httpResponseCode = _http->POST(messageJson);
-        if (httpResponseCode != 200)
+        uint8_t buffer[AI_READ_SLICE];
+        size_t available = _client->available();
+        if (available == 0)
         {
-            handleError("Error adding message: " + String(httpResponseCode));
+            if (!_client->connected())
+            {
+                // A body without chunking ends here, anything else ended early
+                if (_state == State::STREAM && _body == Body::IDENTITY)
+                {
+                    _body = Body::DONE;
+                    finish();
+                }
+                else if (_httpCode == 0 && _reusedConnection)
+                {
+                    // The server had closed the kept connection, try a new one
+                    _client->stop();
+                    _state = State::SEND_REQUEST;
+                }
+                else
+                {
+                    handleError("AI connection closed");
+                }
+            }
             return;
         }
-        _http->end();
 
-        _state = State::CREATE_RUN;
+        size_t length = _client->read(buffer, min(available, sizeof(buffer)));
+        for (size_t i = 0; i < length && isActive(); i++)
+        {
+            if (_state == State::READ_HEADERS)
+            {
+                if (readLine(buffer[i]))
+                {
+                    handleHeaderLine();
+                }
+            }
+            else
+            {
+                feedBody(buffer[i]);
+            }
+        }
         break;
     }
 
-    case State::CREATE_RUN:
-    {
-        String runEndpoint = String(BASE_URL) + "/threads/" + _threadId + "/runs";
-        _http->useHTTP10(true);
-        _http->begin(*_client, runEndpoint);
-        setHeaders();
+    case State::COMPLETE:
+        resetState();
+        break;
+    case State::ERROR:
+        resetState();
+        break;
+    case State::IDLE:
+        // Should never happen here
+        break;
+    }
+}
+
+// Thread and run in one request, the reply is streamed back
+void AiManager::sendRequest()
+{
+    LengthCounter body;
+    writeRequestBody(body);
+
+    SocketWriter out(*_client);
+    out.print("POST /v1/threads/runs HTTP/1.1\r\nHost: ");
+    out.print(_host);
+    out.print("\r\nAuthorization: Bearer ");
+    out.print(_apiKey);
+    out.print("\r\nOpenAI-Beta: assistants=v2\r\n"
+              "Content-Type: application/json\r\n"
+              "Accept: text/event-stream\r\n"
+              "Connection: keep-alive\r\n"
+              "Content-Length: ");
+    out.print(body.length);
+    out.print("\r\n\r\n");
+    writeRequestBody(out);
+}
 
-        String requestData = "{\"assistant_id\":\"" + _assistantId + "\",\"instructions\":\"\"}";
-        int httpResponseCode = _http->POST(requestData);
-        if (httpResponseCode != 200)
+void AiManager::writeRequestBody(Print &out)
+{
+    out.print("{\"assistant_id\":");
+    writeJsonString(out, _assistantId.c_str());
+    out.print(",\"stream\":true,\"thread\":{\"messages\":[{\"role\":\"user\",\"content\":");
+    writeJsonString(out, _prompt.c_str());
+    out.print("}]}}");
+}
+
+// Collect a line, true once it is complete (without CR/LF)
+bool AiManager::readLine(char c)
+{
+    if (c == '\n')
+    {
+        if (_lineLength > 0 && _line[_lineLength - 1] == '\r')
         {
-            handleError("Error creating run: " + String(httpResponseCode));
-            return;
+            _lineLength--;
         }
-        JsonDocument idFilter;
-        idFilter["id"] = true;
-        deserializeJson(*_doc, _http->getStream(), DeserializationOption::Filter(idFilter));
-        _runId = (*_doc)["id"].as<String>();
-        Serial.println("Run ID: " + _runId);
-        _http->end();
-
-        _state = State::POLL_RUN;
-        _lastPollTime = 0; // Initialize for first poll
-        break;
+        _line[_lineLength] = '\0';
+        return true;
     }
+    if (_lineLength < AI_LINE_MAX)
+    {
+        _line[_lineLength++] = c;
+    }
+    return false;
+}
 
-    case State::POLL_RUN:
+void AiManager::handleHeaderLine()
+{
+    if (_httpCode == 0)
     {
-        // We'll poll once every 300ms
-        if (millis() - _lastPollTime < 300)
+        // Status line, "HTTP/1.1 200 OK"
+        const char *space = strchr(_line, ' ');
+        _httpCode = space ? atoi(space + 1) : -1;
+        if (_httpCode != 200)
         {
-            return; // Wait before polling again
+            handleError("Error creating run: " + String(_httpCode));
         }
-        _lastPollTime = millis();
-
-        String runEndpoint = String(BASE_URL) + "/threads/" + _threadId + "/runs";
-        _http->useHTTP10(true);
-        _http->begin(*_client, runEndpoint + "/" + _runId);
-        setHeaders();
+    }
+    else if (_lineLength == 0)
+    {
+        // End of the headers
+        _state = State::STREAM;
+    }
+    else if (strcasecmp(_line, "Transfer-Encoding: chunked") == 0)
+    {
+        _body = Body::CHUNK_SIZE;
+        _chunkRemaining = 0;
+        _chunkExtension = false;
+    }
+    else if (strcasecmp(_line, "Connection: close") == 0)
+    {
+        _keepAlive = false;
+    }
+    _lineLength = 0;
+}
 
-        int httpResponseCode = _http->GET();
-        if (httpResponseCode != 200)
+// Strip the chunked framing, the payload goes to the SSE decoder
+void AiManager::feedBody(char c)
+{
+    switch (_body)
+    {
+    case Body::IDENTITY:
+        break;
+    case Body::CHUNK_SIZE:
+        if (c == '\n')
         {
-            handleError("Error getting run status: " + String(httpResponseCode));
-            return;
+            _body = _chunkRemaining > 0 ? Body::CHUNK_DATA : Body::CHUNK_TRAILER;
         }
-        JsonDocument statusFilter;
-        statusFilter["status"] = true;
-        deserializeJson(*_doc, _http->getStream(), DeserializationOption::Filter(statusFilter));
-        _http->end();
-
-        String status = (*_doc)["status"].as<String>();
-        if (status == "completed")
+        else if (c == ';')
         {
-            _state = State::GET_MESSAGES;
+            _chunkExtension = true;
         }
-        else if (status == "failed" || status == "cancelled")
+        else if (!_chunkExtension && isxdigit(c))
         {
-            handleError("Run ended with status: " + status);
+            _chunkRemaining = _chunkRemaining * 16 + (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+        }
+        return;
+    case Body::CHUNK_DATA:
+        if (--_chunkRemaining == 0)
+        {
+            _body = Body::CHUNK_DATA_END;
         }
         break;
+    case Body::CHUNK_DATA_END:
+        if (c == '\n')
+        {
+            _body = Body::CHUNK_SIZE;
+            _chunkExtension = false;
+        }
+        return;
+    case Body::CHUNK_TRAILER:
+        // Trailer fields up to an empty line, counted in _chunkRemaining
+        if (c == '\n')
+        {
+            if (_chunkRemaining == 0)
+            {
+                _body = Body::DONE;
+                finish();
+            }
+            _chunkRemaining = 0;
+        }
+        else if (c != '\r')
+        {
+            _chunkRemaining++;
+        }
+        return;
+    case Body::DONE:
+        return;
     }
 
-    case State::GET_MESSAGES:
+    feedEvent(c);
+}
+
+// Event stream: field name up to the colon, then its value
+void AiManager::feedEvent(char c)
+{
+    if (c == '\n')
     {
-        _http->useHTTP10(true);
-        _http->begin(*_client, String(BASE_URL) + "/threads/" + _threadId + "/messages");
-        setHeaders();
+        endEventLine();
+        return;
+    }
+    if (c == '\r')
+    {
+        return;
+    }
 
-        int httpResponseCode = _http->GET();
-        if (httpResponseCode != 200)
+    bool leadingSpace = _lineEmpty;
+    _lineEmpty = false;
+    switch (_field)
+    {
+    case Field::NAME:
+        if (c != ':')
         {
-            handleError("Error getting messages: " + String(httpResponseCode));
+            if (_lineLength < AI_LINE_MAX)
+            {
+                _line[_lineLength++] = c;
+            }
             return;
         }
+        _line[_lineLength] = '\0';
+        _lineEmpty = true; // Skips the space after the colon
+        if (strcmp(_line, "event") == 0)
+        {
+            _field = Field::EVENT;
+            _lineLength = 0;
+            _event[0] = '\0';
+        }
+        else if (strcmp(_line, "data") == 0 && strcmp(_event, "thread.message.delta") == 0)
+        {
+            _field = Field::DATA;
+            memset(&_json, 0, sizeof(_json));
+        }
+        else
+        {
+            // Other events carry whole run objects, they are not read
+            _field = Field::IGNORE;
+        }
+        return;
+    case Field::EVENT:
+        if (!(leadingSpace && c == ' ') && _lineLength < sizeof(_event) - 1)
+        {
+            _event[_lineLength++] = c;
+            _event[_lineLength] = '\0';
+        }
+        return;
+    case Field::DATA:
+        feedJson(c);
+        return;
+    case Field::IGNORE:
+        return;
+    }
+}
 
-        JsonDocument msgFilter;
-        msgFilter["data"][0]["content"][0]["text"]["value"] = true;
-        deserializeJson(*_doc, _http->getStream(), DeserializationOption::Filter(msgFilter));
-        _http->end();
+void AiManager::endEventLine()
+{
+    Field field = _field;
+    bool blank = _lineEmpty && field == Field::NAME && _lineLength == 0;
+    _field = Field::NAME;
+    _lineLength = 0;
+    _lineEmpty = true;
 
-        String msg = (*_doc)["data"][0]["content"][0]["text"]["value"].as<String>();
-        String processedMsg = processMessage(msg);
+    if (blank)
+    {
+        // Blank line ends the event
+        _event[0] = '\0';
+        return;
+    }
 
-        // Display the message
-        _animator->stop();
-        vfd_gui_set_pic(PIC_PLAY, true);
-        _animator->set_text_and_run(processedMsg.c_str(), 210);
+    if (field == Field::EVENT)
+    {
+        if (strcmp(_event, "thread.run.completed") == 0)
+        {
+            _runCompleted = true;
+        }
+        else if (strcmp(_event, "thread.run.failed") == 0 ||
+                 strcmp(_event, "thread.run.cancelled") == 0 ||
+                 strcmp(_event, "thread.run.expired") == 0 ||
+                 strcmp(_event, "error") == 0)
+        {
+            handleError(String("Run ended with ") + _event);
+        }
+    }
+    else if (field == Field::DATA && _show && _replyLength > _shownLength)
+    {
+        if (_shownLength == 0)
+        {
+            // First words: replace the loading spinner with the scroll
+            _animator->stop();
+            vfd_gui_set_pic(PIC_PLAY, true);
+            _animator->start_stream(_reply, 210);
+        }
+        else
+        {
+            _animator->stream_append();
+        }
+        _shownLength = _replyLength;
+    }
+}
 
-        // Call the callback if set
-        if (_completeCallback)
+// Streaming JSON scanner, only strings at delta.content[].text.value
+// reach the reply. Assumes well formed input.
+void AiManager::feedJson(char c)
+{
+    JsonScan &json = _json;
+    if (json.inString)
+    {
+        if (json.unicodeDigits > 0)
+        {
+            json.unicode = json.unicode * 16 + (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+            if (--json.unicodeDigits == 0)
+            {
+                emitCodepoint(json.unicode);
+            }
+        }
+        else if (json.escape)
+        {
+            json.escape = false;
+            switch (c)
+            {
+            case 'u':
+                json.unicodeDigits = 4;
+                json.unicode = 0;
+                break;
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+                emitJsonChar(' ');
+                break;
+            default:
+                emitJsonChar(c);
+                break;
+            }
+        }
+        else if (c == '\\')
+        {
+            json.escape = true;
+        }
+        else if (c == '"')
+        {
+            json.inString = false;
+            if (!json.isValue)
+            {
+                json.key[min<size_t>(json.keyLength, AI_JSON_KEY_MAX - 1)] = '\0';
+            }
+        }
+        else
         {
-            _completeCallback(processedMsg);
+            emitJsonChar(c);
         }
+        return;
+    }
 
-        _state = State::COMPLETE;
+    switch (c)
+    {
+    case '"':
+        json.inString = true;
+        json.isValue = json.afterColon;
+        // Levels deeper than AI_JSON_DEPTH have no scope and are not captured
+        json.capture = json.isValue && json.depth > 0 && json.depth <= AI_JSON_DEPTH &&
+                       strcmp(json.key, "value") == 0 && strcmp(json.scope[json.depth - 1], "text") == 0;
+        if (!json.isValue)
+        {
+            json.keyLength = 0;
+        }
+        json.afterColon = false;
         break;
-    }
-    case State::COMPLETE:
-        resetState();
+    case ':':
+        json.afterColon = true;
         break;
-    case State::ERROR:
-        resetState();
+    case '{':
+    case '[':
+        if (json.depth < AI_JSON_DEPTH)
+        {
+            // Array elements belong to the key of the array
+            const char *scope = json.afterColon ? json.key : (json.depth > 0 ? json.scope[json.depth - 1] : "");
+            strlcpy(json.scope[json.depth], scope, AI_JSON_KEY_MAX);
+        }
+        json.depth++;
+        json.afterColon = false;
         break;
-    case State::IDLE:
-        // Should never happen here
+    case '}':
+    case ']':
+        if (json.depth > 0)
+        {
+            json.depth--;
+        }
+        json.afterColon = false;
+        break;
+    case ' ':
+    case '\t':
+        break;
+    default:
+        // Numbers, true, false, null and commas end a value
+        json.afterColon = false;
         break;
     }
 }
 
-void AiManager::resetState()
+void AiManager::emitJsonChar(char c)
 {
-    if (_http)
+    if (_json.capture)
     {
-        _http->end();
-        delete _http;
-        _http = nullptr;
+        processMessage(c);
     }
-    if (_client)
+    else if (!_json.isValue && _json.keyLength < AI_JSON_KEY_MAX)
     {
-        delete _client;
-        _client = nullptr;
+        // Longer keys are never looked for, a truncated one is harmless
+        _json.key[_json.keyLength++] = c;
     }
-    if (_doc)
+}
+
+void AiManager::emitCodepoint(uint16_t codepoint)
+{
+    if (codepoint < 0x80)
     {
-        delete _doc;
-        _doc = nullptr;
+        emitJsonChar(codepoint);
+    }
+    else if (codepoint < 0x800)
+    {
+        emitJsonChar(0xC0 | (codepoint >> 6));
+        emitJsonChar(0x80 | (codepoint & 0x3F));
+    }
+    else if (codepoint < 0xD800 || codepoint > 0xDFFF)
+    {
+        emitJsonChar(0xE0 | (codepoint >> 12));
+        emitJsonChar(0x80 | ((codepoint >> 6) & 0x3F));
+        emitJsonChar(0x80 | (codepoint & 0x3F));
+    }
+    else
+    {
+        // Half of a surrogate pair, the display has nothing for it
+        emitJsonChar('?');
     }
-    _state = State::IDLE;
-    _threadId = "";
-    _runId = "";
-    _prompt = "";
 }
 
-void AiManager::setHeaders()
+// Reply bytes in UTF-8, German umlauts are spelled out for the display
+void AiManager::processMessage(uint8_t c)
 {
-    _http->addHeader("Content-Type", "application/json");
-    _http->addHeader("Authorization", "Bearer " + _apiKey);
-    _http->addHeader("OpenAI-Beta", "assistants=v2");
+    if (_utf8Lead)
+    {
+        uint8_t lead = _utf8Lead;
+        _utf8Lead = 0;
+        for (auto &umlaut : UMLAUTS)
+        {
+            if (umlaut.trail == c)
+            {
+                appendReply(umlaut.replacement[0]);
+                appendReply(umlaut.replacement[1]);
+                return;
+            }
+        }
+        appendReply(lead);
+    }
+
+    if (c == 0xC3)
+    {
+        // Wait for the trail byte, it may come with the next delta
+        _utf8Lead = c;
+        return;
+    }
+    appendReply(c < 0x20 ? ' ' : c);
 }
 
-void AiManager::handleError(const String &errorMessage)
+void AiManager::appendReply(char c)
 {
-    Serial.println(errorMessage);
-    _animator->stop();
-    vfd_gui_set_text("AI ERR");
+    if (_replyLength < AI_REPLY_MAX)
+    {
+        _reply[_replyLength++] = c;
+        _reply[_replyLength] = '\0';
+    }
+}
 
-    // Call the error callback if set
-    if (_errorCallback)
+// The response body is complete
+void AiManager::finish()
+{
+    if (!_runCompleted)
     {
-        _errorCallback(errorMessage);
+        handleError("AI stream ended early");
+        return;
     }
 
-    _state = State::ERROR;
+    if (!_keepAlive)
+    {
+        _client->stop();
+    }
+
+    // Kept open for the next request unless someone else needs it
+    TlsPool::release(this);
+
+    if (_show)
+    {
+        _animator->stream_end();
+    }
+
+    // Call the callback if set
+    if (_completeCallback)
+    {
+        _completeCallback(String(_reply));
+    }
+
+    _state = State::COMPLETE;
+}
+
+void AiManager::resetState()
+{
+    _state = State::IDLE;
+    _prompt = "";
 }
 
-String AiManager::processMessage(const String &message)
+void AiManager::handleError(const String &errorMessage)
 {
-    String result = message;
+    Serial.println(errorMessage);
+    if (_show)
+    {
+        _animator->stop();
+        vfd_gui_set_text("AI ERR");
+    }
 
-    // Process character conversion (German umlauts)
-    const char *replacements[][2] = {
-        {"ä", "ae"}, {"ö", "oe"}, {"ü", "ue"}, {"Ä", "Ae"}, {"Ö", "Oe"}, {"Ü", "Ue"}, {"ß", "ss"}};
+    // The response was not read to its end, the connection is unusable
+    if (_client)
+    {
+        _client->stop();
+    }
+    TlsPool::release(this);
 
-    for (auto &pair : replacements)
+    // Call the error callback if set
+    if (_errorCallback)
     {
-        result.replace(pair[0], pair[1]);
+        _errorCallback(errorMessage);
     }
 
-    return result;
-}
\ No newline at end of file
+    _state = State::ERROR;
+}
@@ -3,84 +3,187 @@
 
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
-#include <ESP8266HTTPClient.h>
 #include <WiFiClientSecure.h>
-#include <ArduinoJson.h>
+#include <functional>
+#include <memory>
+#include <tlspool.h>
+
+// Longest reply shown, later tokens are dropped
+#define AI_REPLY_MAX 1024
+
+// Longest HTTP header line or SSE event name kept, the rest is cut off.
+// Event data is never buffered.
+#define AI_LINE_MAX 128
+
+// JSON nesting followed while looking for delta.content[].text.value
+#define AI_JSON_DEPTH 8
+#define AI_JSON_KEY_MAX 12
 
 // Forward declaration
 class Animator;
 
+// Assistant conversation over a streamed run
+//
+// One request creates the thread and the run with "stream": true, the
+// reply arrives as server-sent events on the same response. process()
+// only reads what the socket has, decodes the chunked body and SSE lines
+// incrementally and appends each text delta to the scroll buffer, so the
+// first words show while the run is still going.
+//
+// Nothing on this path allocates per message: the request is written to
+// the socket by a small JSON writer, and the delta text is unescaped
+// straight out of the event data into the fixed reply buffer by a
+// streaming JSON scanner. Memory use is this object plus the TLS buffers.
+//
+// The TLS connection comes from TlsPool and is left open after a reply,
+// the next conversation skips the handshake if the server kept it.
 class AiManager {
 public:
     // Constructor
     AiManager(Animator* animator, const char* apiKey, const char* assistantId);
-    
+
     // Destructor
     ~AiManager();
-    
+
     // Initialize the AI manager
     void begin();
-    
+
     // Main process function (call this in your loop)
     void process();
-    
-    // Start a conversation
-    void startConversation(const char* prompt = "hi");
-    
+
+    // Start a conversation. Without `show` the reply is only handed to
+    // the complete callback, the display is left alone.
+    void startConversation(const char* prompt = "hi", bool show = true);
+
     // Is a conversation active?
     bool isActive() const;
-    
+
+    // Talk to another server, e.g. a local stub over plain HTTP
+    void setEndpoint(const char* host, uint16_t port, bool secure);
+
     // Set callback for when conversation completes
-    void onComplete(void (*callback)(const String& message));
-    
+    void onComplete(std::function<void(const String& message)> callback);
+
     // Set callback for when error occurs
-    void onError(void (*callback)(const String& errorMessage));
-    
+    void onError(std::function<void(const String& errorMessage)> callback);
+
+    // Reply of the last conversation, also while it is streaming
+    const char* reply() const { return _reply; }
+    size_t replyLength() const { return _replyLength; }
+
 private:
     // State machine for the AI conversation process
     enum class State {
         IDLE,
-        CREATE_THREAD,
-        ADD_MESSAGE,
-        CREATE_RUN,
-        POLL_RUN,
-        GET_MESSAGES,
+        SEND_REQUEST,
+        READ_HEADERS,
+        STREAM,
         COMPLETE,
         ERROR
     };
-    
+
+    // Position in the response body
+    enum class Body {
+        IDENTITY,       // Not chunked, ends when the server closes
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END,
+        CHUNK_TRAILER,
+        DONE
+    };
+
     // Reset the state machine
     void resetState();
-    
-    // Helper to set common headers
-    void setHeaders();
-    
+
+    // Connect, or reuse the open connection
+    bool connect();
+
     // Handle error with message
     void handleError(const String& errorMessage);
-    
-    // Process the message (handle character replacements)
-    String processMessage(const String& message);
-    
+
+    // Write the request, the body is measured first for Content-Length
+    void sendRequest();
+    void writeRequestBody(Print& out);
+
+    // Feed response bytes through the line, chunk, SSE and JSON decoders
+    bool readLine(char c);
+    void handleHeaderLine();
+    void feedBody(char c);
+    void feedEvent(char c);
+    void endEventLine();
+    void feedJson(char c);
+    void emitJsonChar(char c);
+    void emitCodepoint(uint16_t codepoint);
+    void finish();
+
+    // Append reply bytes, German umlauts are spelled out
+    void processMessage(uint8_t c);
+    void appendReply(char c);
+
     // Instance variables
     Animator* _animator;
     String _apiKey;
     String _assistantId;
     State _state = State::IDLE;
-    
-    WiFiClientSecure* _client = nullptr;
-    HTTPClient* _http = nullptr;
-    JsonDocument* _doc = nullptr;
-    
-    String _threadId;
-    String _runId;
+
+    String _host = "api.openai.com";
+    uint16_t _port = 443;
+    bool _secure = true;
+    WiFiClient* _client = nullptr;        // From TlsPool, or _plainClient
+    std::unique_ptr<WiFiClient> _plainClient;
+    bool _reusedConnection = false;
+
     String _prompt;
-    
+    bool _show = true;
+
+    // HTTP and chunk decoder state
+    char _line[AI_LINE_MAX + 1];
+    size_t _lineLength = 0;
+    int _httpCode = 0;
+    bool _keepAlive = false;
+    Body _body = Body::IDENTITY;
+    size_t _chunkRemaining = 0;
+    bool _chunkExtension = false;
+
+    // SSE decoder state, _line holds the field name
+    enum class Field {
+        NAME,
+        EVENT,
+        DATA,
+        IGNORE
+    };
+    Field _field = Field::NAME;
+    bool _lineEmpty = true;
+    char _event[40];
+    bool _runCompleted = false;
+
+    // JSON scanner state for delta event data
+    struct JsonScan {
+        uint8_t depth;
+        bool inString;
+        bool escape;
+        bool afterColon;
+        bool isValue;      // The current string is a value, not a key
+        bool capture;      // ... and it is the delta text
+        uint8_t unicodeDigits;
+        uint16_t unicode;
+        uint8_t keyLength;
+        char key[AI_JSON_KEY_MAX];
+        char scope[AI_JSON_DEPTH][AI_JSON_KEY_MAX]; // Key that opened each level
+    };
+    JsonScan _json;
+    uint8_t _utf8Lead = 0;
+
+    // Reply scrolled by the animator while it grows
+    char _reply[AI_REPLY_MAX + 1];
+    size_t _replyLength = 0;
+    size_t _shownLength = 0;
+
     unsigned long _stateStartTime = 0;
-    unsigned long _lastPollTime = 0;
     const unsigned long _aiTimeout = 30000; // 30 seconds timeout
-    
-    void (*_completeCallback)(const String& message) = nullptr;
-    void (*_errorCallback)(const String& errorMessage) = nullptr;
+
+    std::function<void(const String& message)> _completeCallback;
+    std::function<void(const String& errorMessage)> _errorCallback;
 };
 
-#endif // AI_MANAGER_H
\ No newline at end of file
+#endif // AI_MANAGER_H
@@ -1,6 +1,21 @@
 #include "mqtt_manager.h"
 #include <ESP8266WiFi.h>
 #include <LittleFS.h>
+#include <algorithm>
+#include <tlspool.h>
+
+// Telemetry schema: topic below the out topic, smallest change worth publishing
+const MqttManager::MetricInfo MqttManager::METRICS[METRIC_COUNT] = {
+    {"flash-size", 0},
+    {"cpu-frequency", 0},
+    {"fs-total", 0},
+    {"fs-used", 4096},
+    {"free-heap", 512},
+    {"heap-frag", 2},
+    {"free-stack", 128},
+    {"tls-handshakes", 0},
+    {"tls-handshake-ms", 0},
+};
 
 // Constructor with default values
 MqttManager::MqttManager(const char *server, int port, const char *inTopic)
@@ -23,43 +38,69 @@ void MqttManager::begin()
     // Set server and callback
     mqttClient.setServer(mqttServer.c_str(), mqttPort);
 
+    // Keep a connection attempt to an unreachable broker short
+    wifiClient.setTimeout(MQTT_CONNECT_TIMEOUT_MS);
+    mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+    mqttClient.setBufferSize(MQTT_PACKET_SIZE);
+
     // Set up callback
     mqttClient.setCallback([this](char *topic, byte *payload, unsigned int length)
-                           {
-         // Convert payload to null-terminated string
-         char message[length + 1];
-         memcpy(message, payload, length);
-         message[length] = '\0';
-         
-         // Debug output
-         Serial.print("MQTT message arrived [");
-         Serial.print(topic);
-         Serial.print("]: ");
-         Serial.println(message);
-
-         // find last / in topic and remove the prefix
-        char *lastSlash = strrchr(topic, '/');
-        if (lastSlash) {
-            topic = lastSlash + 1;
-        }
-         
-         // Call the user callback with the message
-         if (messageCallback) {
-             messageCallback(topic, message);
-         } });
+                           { dispatch(topic, payload, length); });
+
+    // The first attempt is made from loop() once WiFi is up
+    lastReconnectAttempt = millis();
+    retryDelay = 0;
+}
+
+// Route an incoming message by the last level of its topic
+void MqttManager::dispatch(char *topic, const uint8_t *payload, unsigned int length)
+{
+    // find last / in topic and remove the prefix
+    char *lastSlash = strrchr(topic, '/');
+    if (lastSlash)
+    {
+        topic = lastSlash + 1;
+    }
+
+    Serial.printf("MQTT message arrived [%s]: %u bytes\n", topic, length);
+
+    const MqttCommand *command = findCommand(topic);
+    if (command)
+    {
+        command->handler(commandContext, (const char *)payload, length);
+        return;
+    }
+
+    if (messageCallback)
+    {
+        // The callback wants a null-terminated string
+        char message[length + 1];
+        memcpy(message, payload, length);
+        message[length] = '\0';
+        messageCallback(topic, message);
+    }
+}
 
-    // Try to connect
-    reconnect();
+const MqttCommand *MqttManager::findCommand(const char *name) const
+{
+    const MqttCommand *end = commands + commandCount;
+    const MqttCommand *command = std::lower_bound(commands, end, name,
+                                                  [](const MqttCommand &entry, const char *key)
+                                                  { return strcmp(entry.name, key) < 0; });
+    if (command != end && strcmp(command->name, name) == 0)
+    {
+        return command;
+    }
+    return nullptr;
 }
 
-// Reconnect to MQTT server if connection is lost
+// Attempt a connection now if the backoff allows it
 void MqttManager::reconnect()
 {
     unsigned long now = millis();
-    if (now - lastReconnectAttempt < 2000 || !WiFi.isConnected())
+    if (now - lastReconnectAttempt < retryDelay || !WiFi.isConnected())
     {
-        // Do nothing if the last attempt was less than 2 seconds ago.
-        // we are inside the runloop and get called every loop
+        // Still backing off, we are inside the runloop and get called every loop
         return;
     }
     lastReconnectAttempt = now;
@@ -72,13 +113,18 @@ void MqttManager::reconnect()
     // Attempt to connect
     if (mqttClient.connect(mqttClientId.c_str(), (mqttOutTopic + "online").c_str(), 0, true, "0"))
     {
-        Serial.println("connected");
+        Serial.printf("connected after %lu ms\n", millis() - now);
+        scheduleRetry(false);
+
+        // Subscribe to the input topic
+        mqttClient.subscribe(mqttInTopic.c_str());
+
+        // Messages from while we were offline go out first
+        drainQueue();
 
         // Once connected, publish an announcement
         this->publish("VFD device connected");
         this->publishStatus();
-        // Subscribe to the input topic
-        mqttClient.subscribe(mqttInTopic.c_str());
 
         // Call the connection state callback if state changed
         if (!previousConnectionState && connectionStateCallback)
@@ -89,9 +135,10 @@ void MqttManager::reconnect()
     }
     else
     {
+        scheduleRetry(true);
         Serial.print("failed, rc=");
         Serial.print(mqttClient.state());
-        Serial.println(" retry in 2 seconds");
+        Serial.printf(" retry in %lu ms\n", retryDelay);
 
         // Call the connection state callback if state changed
         if (previousConnectionState && connectionStateCallback)
@@ -102,6 +149,20 @@ void MqttManager::reconnect()
     }
 }
 
+// Exponential backoff with equal jitter, so devices that lost the broker
+// together do not reconnect in lockstep
+void MqttManager::scheduleRetry(bool failed)
+{
+    if (!failed)
+    {
+        backoffDelay = MQTT_BACKOFF_MIN;
+        retryDelay = 0;
+        return;
+    }
+    retryDelay = backoffDelay / 2 + random(backoffDelay / 2 + 1);
+    backoffDelay = min(backoffDelay * 2, (unsigned long)MQTT_BACKOFF_MAX);
+}
+
 // Main loop function to maintain MQTT connection
 void MqttManager::loop()
 {
@@ -116,13 +177,23 @@ void MqttManager::loop()
             connectionStateCallback(currentConnectionState);
         }
         previousConnectionState = currentConnectionState;
+
+        if (!currentConnectionState)
+        {
+            // Lost the broker, start backing off from the minimum
+            lastReconnectAttempt = millis();
+            backoffDelay = MQTT_BACKOFF_MIN;
+            scheduleRetry(true);
+        }
     }
 
     if (!currentConnectionState)
     {
         reconnect();
+        return;
     }
     mqttClient.loop();
+    drainQueue();
 }
 
 // Set message callback
@@ -131,6 +202,13 @@ void MqttManager::onMessage(MessageCallback callback)
     messageCallback = callback;
 }
 
+void MqttManager::setCommands(const MqttCommand *table, size_t count, void *context)
+{
+    commands = table;
+    commandCount = count;
+    commandContext = context;
+}
+
 // Set connection state change callback
 void MqttManager::onConnectionStateChange(ConnectionStateCallback callback)
 {
@@ -151,9 +229,96 @@ bool MqttManager::publish(const char *message)
 }
 
 // Publish a message to a specific topic
-bool MqttManager::publish(const char *topic, const char *message, bool retain)
+bool MqttManager::publish(const char *topic, const char *message, bool retain, uint8_t qos)
+{
+    // Keep the order: while messages are queued new ones go behind them
+    if (queueCount == 0 && mqttClient.connected() && send(topic, message, retain))
+    {
+        return true;
+    }
+    return enqueue(topic, message, retain, qos);
+}
+
+bool MqttManager::send(const char *topic, const char *message, bool retain)
 {
-    return mqttClient.publish((mqttOutTopic + topic).c_str(), message, retain);
+    // The prefix is built once in the constructor, only the suffix is added
+    char fullTopic[64 + MQTT_QUEUE_TOPIC_MAX];
+    snprintf(fullTopic, sizeof(fullTopic), "%s%s", mqttOutTopic.c_str(), topic);
+    if (!mqttClient.publish(fullTopic, message, retain))
+    {
+        return false;
+    }
+    sentMessages++;
+    sentBytes += strlen(fullTopic) + strlen(message);
+    return true;
+}
+
+bool MqttManager::enqueue(const char *topic, const char *message, bool retain, uint8_t qos)
+{
+    if (strlen(topic) >= MQTT_QUEUE_TOPIC_MAX || strlen(message) >= MQTT_QUEUE_PAYLOAD_MAX)
+    {
+        Serial.printf("MQTT message for %s too large to queue, dropped\n", topic);
+        droppedMessages++;
+        return false;
+    }
+
+    if (queueCount == MQTT_QUEUE_SIZE)
+    {
+        // Make room: the oldest QoS 0 message goes first, QoS 1 messages
+        // only when nothing else is left
+        uint8_t victim = 0;
+        for (uint8_t i = 0; i < queueCount; i++)
+        {
+            if (queue[(queueHead + i) % MQTT_QUEUE_SIZE].qos == 0)
+            {
+                victim = i;
+                break;
+            }
+        }
+        if (qos == 0 && queue[(queueHead + victim) % MQTT_QUEUE_SIZE].qos > 0)
+        {
+            // Queue is all QoS 1, the new QoS 0 message loses
+            droppedMessages++;
+            return false;
+        }
+        dropQueued(victim);
+        droppedMessages++;
+    }
+
+    QueuedMessage &slot = queue[(queueHead + queueCount) % MQTT_QUEUE_SIZE];
+    strcpy(slot.topic, topic);
+    strcpy(slot.payload, message);
+    slot.qos = qos;
+    slot.retain = retain;
+    queueCount++;
+    return true;
+}
+
+// Remove the message at `position` (0 = oldest) and close the gap
+void MqttManager::dropQueued(uint8_t position)
+{
+    for (uint8_t i = position; i > 0; i--)
+    {
+        queue[(queueHead + i) % MQTT_QUEUE_SIZE] = queue[(queueHead + i - 1) % MQTT_QUEUE_SIZE];
+    }
+    queueHead = (queueHead + 1) % MQTT_QUEUE_SIZE;
+    queueCount--;
+}
+
+// Send queued messages, oldest first
+void MqttManager::drainQueue()
+{
+    while (queueCount > 0 && mqttClient.connected())
+    {
+        QueuedMessage &message = queue[queueHead];
+        if (!send(message.topic, message.payload, message.retain) && message.qos > 0)
+        {
+            // Keep it for the next round, the connection is likely gone
+            return;
+        }
+        // Written, or a QoS 0 message that had its one attempt
+        dropQueued(0);
+    }
 }
 
 // Subscribe to a topic
@@ -196,34 +361,80 @@ void MqttManager::setTopics(const char *inTopic, const char *outTopic)
 
 void MqttManager::publishStatus()
 {
+    // Identity does not change while connected, send it once
+    char value[24];
     publish("online", "1", true);
-    publish("chip-id", String(ESP.getChipId(), HEX).c_str());
-    publish("ip", WiFi.localIP().toString().c_str());
-    publish("mac", WiFi.macAddress().c_str());
-    // flash chip size
-    publish("flash-size", String(ESP.getFlashChipSize()).c_str());
-    // core version
+    snprintf(value, sizeof(value), "%x", ESP.getChipId());
+    publish("chip-id", value);
+    IPAddress ip = WiFi.localIP();
+    snprintf(value, sizeof(value), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    publish("ip", value);
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(value, sizeof(value), "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    publish("mac", value);
     publish("core-version", ESP.getCoreVersion().c_str());
-    // sdk version
     publish("sdk-version", ESP.getSdkVersion());
-    // reset reason
     publish("reset-reason", ESP.getResetReason().c_str());
-    // CPU frequency
-    publish("cpu-frequency", String(ESP.getCpuFreqMHz()).c_str());
-    // get fsinfo from littlefs
-    FSInfo fs_info;
-    LittleFS.info(fs_info);
-    publish("fs-total", String(fs_info.totalBytes).c_str());
-    publish("fs-used", String(fs_info.usedBytes).c_str());
-    publishDynamic();
+
+    // A new connection gets every metric once
+    publishedMask = 0;
+    publishMetrics(0, METRIC_COUNT);
 }
 
 void MqttManager::publishDynamic()
 {
-    // free heap
-    publish("free-heap", String(ESP.getFreeHeap()).c_str());
-    // heap fragmentation
-    publish("heap-frag", String(ESP.getHeapFragmentation()).c_str());
-    // stack
-    publish("free-stack", String(ESP.getFreeContStack()).c_str());
-}
\ No newline at end of file
+    publishMetrics(METRIC_FIRST_DYNAMIC, METRIC_COUNT);
+}
+
+void MqttManager::sampleMetrics(uint32_t *values, uint8_t first, uint8_t last)
+{
+    FSInfo fs_info = {};
+    if (first <= METRIC_FS_USED && last > METRIC_FS_TOTAL)
+    {
+        // get fsinfo from littlefs
+        LittleFS.info(fs_info);
+    }
+
+    for (uint8_t metric = first; metric < last; metric++)
+    {
+        switch (metric)
+        {
+        case METRIC_FLASH_SIZE: values[metric] = ESP.getFlashChipSize(); break;
+        case METRIC_CPU_FREQUENCY: values[metric] = ESP.getCpuFreqMHz(); break;
+        case METRIC_FS_TOTAL: values[metric] = fs_info.totalBytes; break;
+        case METRIC_FS_USED: values[metric] = fs_info.usedBytes; break;
+        case METRIC_FREE_HEAP: values[metric] = ESP.getFreeHeap(); break;
+        case METRIC_HEAP_FRAG: values[metric] = ESP.getHeapFragmentation(); break;
+        case METRIC_FREE_STACK: values[metric] = ESP.getFreeContStack(); break;
+        case METRIC_TLS_HANDSHAKES: values[metric] = TlsPool::stats().handshakes; break;
+        case METRIC_TLS_HANDSHAKE_TIME: values[metric] = TlsPool::stats().handshakeMillis; break;
+        }
+    }
+}
+
+// Publish the metrics in [first, last) that changed by more than their deadband
+void MqttManager::publishMetrics(uint8_t first, uint8_t last)
+{
+    uint32_t values[METRIC_COUNT];
+    sampleMetrics(values, first, last);
+
+    char value[12];
+    for (uint8_t metric = first; metric < last; metric++)
+    {
+        uint32_t previous = publishedMetrics[metric];
+        uint32_t change = values[metric] > previous ? values[metric] - previous : previous - values[metric];
+        if ((publishedMask & (1 << metric)) && change <= METRICS[metric].deadband)
+        {
+            continue;
+        }
+
+        snprintf(value, sizeof(value), "%u", values[metric]);
+        if (publish(METRICS[metric].topic, value))
+        {
+            publishedMetrics[metric] = values[metric];
+            publishedMask |= 1 << metric;
+        }
+    }
+}
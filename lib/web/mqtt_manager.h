@@ -6,7 +6,67 @@
  #include <WiFiClient.h>
  #include <functional>
  #include <vector>
+ #include <string.h>
  
+ // Outbound queue: messages published while offline, or that failed,
+ // wait here and are sent once the connection is back
+ #define MQTT_QUEUE_SIZE 8
+ #define MQTT_QUEUE_TOPIC_MAX 32    // Topic below the out topic prefix
+ #define MQTT_QUEUE_PAYLOAD_MAX 128
+ 
+ // Largest packet sent or received, the boot timeline is the longest
+ #define MQTT_PACKET_SIZE 384
+ 
+ // Reconnect backoff (ms), doubled per failed attempt with random jitter
+ #define MQTT_BACKOFF_MIN 1000
+ #define MQTT_BACKOFF_MAX 120000
+ 
+ // Upper bound for one connection attempt: TCP connect (ms) and CONNACK (s)
+ #define MQTT_CONNECT_TIMEOUT_MS 1500
+ #define MQTT_SOCKET_TIMEOUT_S 2
+ 
+ // Command received on <in topic>/<name>. The handler gets the payload as
+ // PubSubClient delivered it: not copied and not null terminated, only
+ // valid until the handler returns.
+ struct MqttCommand {
+     const char* name;
+     void (*handler)(void* context, const char* payload, size_t length);
+ };
+ 
+ // For static_assert on command tables, which must be sorted by name
+ constexpr int mqttCommandCompare(const char* a, const char* b)
+ {
+     return (*a != *b || *a == '\0') ? (unsigned char)*a - (unsigned char)*b
+                                     : mqttCommandCompare(a + 1, b + 1);
+ }
+ 
+ constexpr bool mqttCommandsSorted(const MqttCommand* commands, size_t count)
+ {
+     return count < 2 || (mqttCommandCompare(commands[0].name, commands[1].name) < 0 &&
+                          mqttCommandsSorted(commands + 1, count - 1));
+ }
+ 
+ // MQTT connection manager
+ //
+ // The connection is kept from loop(): attempts are only made while WiFi
+ // is up and are spaced by a jittered exponential backoff, and each one
+ // is bounded by short TCP and CONNACK timeouts instead of PubSubClient's
+ // 15 second default. An attempt still blocks loop() for up to
+ // MQTT_CONNECT_TIMEOUT_MS plus MQTT_SOCKET_TIMEOUT_S while the broker is
+ // unreachable. Publishing never blocks on a missing connection,
+ // messages are queued in a fixed ring instead.
+ //
+ // QoS 0 messages get one attempt and are the first to be dropped when
+ // the queue is full. A qos > 0 message stays queued until it has been
+ // written to the socket. PubSubClient itself only publishes at QoS 0
+ // and PUBACKs are not tracked, so a message written just before the
+ // connection dies is still lost.
+ //
+ // mqtt_stub.py is a broker to run on the host for trying this out.
+ //
+ // Incoming messages are routed by the last topic level through a command
+ // table sorted by name (binary search, no copies, no allocation).
+ // Topics that are not in the table go to the onMessage callback.
  class MqttManager {
  public:
      // Constructor with default values
@@ -17,7 +77,7 @@
      // Initialize MQTT connection
      void begin();
      
-     // Reconnect to MQTT server if connection is lost
+     // Attempt a connection now if the backoff allows it
      void reconnect();
      
      // Main loop function to maintain MQTT connection
@@ -27,6 +87,10 @@
      typedef std::function<void(const char* topic, const char* payload)> MessageCallback;
      void onMessage(MessageCallback callback);
      
+     // Route messages through `commands`, sorted by name, handlers are
+     // called with `context`. The table must outlive the manager.
+     void setCommands(const MqttCommand* commands, size_t count, void* context);
+     
      // Set connection state change callback
      typedef std::function<void(bool connected)> ConnectionStateCallback;
      void onConnectionStateChange(ConnectionStateCallback callback);
@@ -34,14 +98,27 @@
      // Publish a message to the out topic
      bool publish(const char* message);
      
-     // Publish a message to a specific topic
-     bool publish(const char* topic, const char* message, bool retain = false);
+     // Publish a message to a specific topic. Returns false only if the
+     // message could be neither sent nor queued. A qos > 0 message is
+     // retried until it has been written to the socket.
+     bool publish(const char* topic, const char* message, bool retain = false, uint8_t qos = 0);
+     
+     // Messages waiting for the connection
+     size_t queuedMessages() const { return queueCount; }
+     
+     // Messages dropped because the queue was full or they did not fit
+     uint32_t droppedMessageCount() const { return droppedMessages; }
 
-     // publish status values
+     // publish status values: device identity once per connection,
+     // then all metrics
      void publishStatus();
 
-     // publish dynamic values
+     // publish dynamic values that changed noticeably since last time
      void publishDynamic();
+
+     // Traffic since boot
+     uint32_t sentMessageCount() const { return sentMessages; }
+     uint32_t sentByteCount() const { return sentBytes; }
      
      // Subscribe to a topic
      bool subscribe(const char* topic);
@@ -56,9 +133,52 @@
      void setTopics(const char* inTopic, const char* outTopic);
  
  private:
+     // Telemetry schema, status metrics first, then the dynamic ones
+     enum Metric : uint8_t {
+         METRIC_FLASH_SIZE,
+         METRIC_CPU_FREQUENCY,
+         METRIC_FS_TOTAL,
+         METRIC_FS_USED,
+         METRIC_FREE_HEAP,
+         METRIC_HEAP_FRAG,
+         METRIC_FREE_STACK,
+         METRIC_TLS_HANDSHAKES,
+         METRIC_TLS_HANDSHAKE_TIME,
+         METRIC_COUNT,
+         METRIC_FIRST_DYNAMIC = METRIC_FREE_HEAP
+     };
+ 
+     struct MetricInfo {
+         const char* topic;
+         uint32_t deadband; // Smaller changes are not published
+     };
+ 
+     static const MetricInfo METRICS[METRIC_COUNT];
+ 
+     // Values as last published, valid where the bit in publishedMask is set
+     uint32_t publishedMetrics[METRIC_COUNT] = {};
+     uint16_t publishedMask = 0;
+     uint32_t sentMessages = 0;
+     uint32_t sentBytes = 0;
+ 
+     struct QueuedMessage {
+         char topic[MQTT_QUEUE_TOPIC_MAX];
+         char payload[MQTT_QUEUE_PAYLOAD_MAX];
+         uint8_t qos;
+         bool retain;
+     };
+ 
      WiFiClient wifiClient;
      PubSubClient mqttClient;
      unsigned long lastReconnectAttempt = 0;
+     unsigned long backoffDelay = MQTT_BACKOFF_MIN;
+     unsigned long retryDelay = 0;
+ 
+     // Ring of queued messages, oldest at queueHead
+     QueuedMessage queue[MQTT_QUEUE_SIZE];
+     uint8_t queueHead = 0;
+     uint8_t queueCount = 0;
+     uint32_t droppedMessages = 0;
      String mqttServer;
      int mqttPort;
      String mqttInTopic;
@@ -68,6 +188,19 @@
      
      MessageCallback messageCallback;
      ConnectionStateCallback connectionStateCallback;
+     const MqttCommand* commands = nullptr;
+     size_t commandCount = 0;
+     void* commandContext = nullptr;
+ 
+     void dispatch(char* topic, const uint8_t* payload, unsigned int length);
+     const MqttCommand* findCommand(const char* name) const;
+     bool send(const char* topic, const char* message, bool retain);
+     bool enqueue(const char* topic, const char* message, bool retain, uint8_t qos);
+     void dropQueued(uint8_t position);
+     void drainQueue();
+     void scheduleRetry(bool failed);
+     void sampleMetrics(uint32_t* values, uint8_t first, uint8_t last);
+     void publishMetrics(uint8_t first, uint8_t last);
  };
  
  #endif // MQTT_MANAGER_H
\ No newline at end of file
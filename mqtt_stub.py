@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Local stand-in for the MQTT broker.
+
+A small MQTT 3.1.1 broker for trying MqttManager against: it logs every
+connection and message, routes messages between clients (+ and #
+wildcards), keeps retained messages and answers QoS 1 publishes with
+PUBACK. Set the device's MQTT server to the host's address, then
+
+    mqtt_stub.py [--port 1883] [--outage 10:30] [--drop-after 5]
+
+--outage UP:DOWN alternates UP seconds of service with DOWN seconds in
+which the port refuses connections, to watch the reconnect backoff and
+the queue draining afterwards. --drop-after N closes a connection after
+N publishes from it. Lines typed on stdin as "<topic> <payload>" are
+published to the clients, e.g. "vfd/<chip id>/cmd/night 22 6 1". The
+device subscribes to vfd/<chip id>/cmd/#, the chip id in hex is also its
+client id in the "connect" and "subscribe" lines.
+"""
+import argparse
+import socket
+import struct
+import sys
+import threading
+import time
+
+CONNECT, CONNACK, PUBLISH, PUBACK = 1, 2, 3, 4
+SUBSCRIBE, SUBACK, UNSUBSCRIBE, UNSUBACK = 8, 9, 10, 11
+PINGREQ, PINGRESP, DISCONNECT = 12, 13, 14
+
+lock = threading.Lock()
+clients = {}   # socket -> (client id, [topic filters])
+retained = {}  # topic -> payload
+
+
+def log(*items):
+    print(time.strftime("%H:%M:%S"), *items, flush=True)
+
+
+def encode_length(length):
+    out = bytearray()
+    while True:
+        byte, length = length % 128, length // 128
+        out.append(byte | (0x80 if length else 0))
+        if not length:
+            return bytes(out)
+
+
+def packet(kind, flags, body):
+    return bytes([kind << 4 | flags]) + encode_length(len(body)) + body
+
+
+def string(text):
+    data = text.encode() if isinstance(text, str) else text
+    return struct.pack(">H", len(data)) + data
+
+
+def read_exact(conn, count):
+    data = b""
+    while len(data) < count:
+        chunk = conn.recv(count - len(data))
+        if not chunk:
+            raise ConnectionError
+        data += chunk
+    return data
+
+
+def read_packet(conn):
+    header = read_exact(conn, 1)[0]
+    length, shift = 0, 0
+    while True:
+        byte = read_exact(conn, 1)[0]
+        length |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            break
+    return header >> 4, header & 0x0F, read_exact(conn, length)
+
+
+def matches(pattern, topic):
+    want, have = pattern.split("/"), topic.split("/")
+    for i, level in enumerate(want):
+        if level == "#":
+            return True
+        if i >= len(have) or (level != "+" and level != have[i]):
+            return False
+    return len(want) == len(have)
+
+
+def route(topic, payload, retain, sender=None):
+    if retain:
+        if payload:
+            retained[topic] = payload
+        else:
+            retained.pop(topic, None)
+    message = packet(PUBLISH, 0, string(topic) + payload)
+    for conn, (_, filters) in list(clients.items()):
+        if conn is not sender and any(matches(f, topic) for f in filters):
+            try:
+                conn.sendall(message)
+            except OSError:
+                pass
+
+
+def serve(conn, address):
+    publishes = 0
+    try:
+        kind, _, body = read_packet(conn)
+        if kind != CONNECT:
+            return
+        # Variable header: protocol name, level, flags, keepalive
+        name_length = struct.unpack(">H", body[:2])[0]
+        offset = 2 + name_length + 4
+        id_length = struct.unpack(">H", body[offset:offset + 2])[0]
+        client_id = body[offset + 2:offset + 2 + id_length].decode(errors="replace")
+        conn.sendall(packet(CONNACK, 0, b"\x00\x00"))
+        with lock:
+            clients[conn] = (client_id, [])
+        log("connect", client_id, "from", address[0])
+
+        while True:
+            kind, flags, body = read_packet(conn)
+            if kind == PUBLISH:
+                topic_length = struct.unpack(">H", body[:2])[0]
+                topic = body[2:2 + topic_length].decode(errors="replace")
+                offset = 2 + topic_length
+                qos = flags >> 1 & 3
+                if qos:
+                    conn.sendall(packet(PUBACK, 0, body[offset:offset + 2]))
+                    offset += 2
+                payload = body[offset:]
+                log("publish", client_id, topic, "qos%d" % qos, "retained" if flags & 1 else "",
+                    payload.decode(errors="replace"))
+                with lock:
+                    route(topic, payload, flags & 1, conn)
+                publishes += 1
+                if args.drop_after and publishes >= args.drop_after:
+                    log("dropping", client_id, "after", publishes, "publishes")
+                    return
+            elif kind == SUBSCRIBE:
+                packet_id, offset, granted = body[:2], 2, b""
+                filters = []
+                while offset < len(body):
+                    length = struct.unpack(">H", body[offset:offset + 2])[0]
+                    filters.append(body[offset + 2:offset + 2 + length].decode())
+                    offset += 2 + length + 1
+                    granted += b"\x00"
+                conn.sendall(packet(SUBACK, 0, packet_id + granted))
+                log("subscribe", client_id, *filters)
+                with lock:
+                    clients[conn][1].extend(filters)
+                    for topic, payload in retained.items():
+                        if any(matches(f, topic) for f in filters):
+                            conn.sendall(packet(PUBLISH, 1, string(topic) + payload))
+            elif kind == UNSUBSCRIBE:
+                conn.sendall(packet(UNSUBACK, 0, body[:2]))
+            elif kind == PINGREQ:
+                conn.sendall(packet(PINGRESP, 0, b""))
+            elif kind == DISCONNECT:
+                return
+    except (ConnectionError, OSError):
+        pass
+    finally:
+        with lock:
+            client = clients.pop(conn, None)
+        conn.close()
+        if client:
+            log("disconnect", client[0])
+
+
+def console():
+    for line in sys.stdin:
+        topic, _, payload = line.strip().partition(" ")
+        if topic:
+            with lock:
+                route(topic, payload.encode(), False)
+
+
+def listen():
+    server = socket.socket()
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("", args.port))
+    server.listen()
+    return server
+
+
+def main():
+    threading.Thread(target=console, daemon=True).start()
+    server = listen()
+    up_until = time.time() + args.outage[0] if args.outage else None
+    while True:
+        if up_until and time.time() > up_until:
+            # Close the port and every connection, then come back
+            log("outage for", args.outage[1], "s")
+            server.close()
+            with lock:
+                for conn in list(clients):
+                    try:
+                        conn.shutdown(socket.SHUT_RDWR)
+                    except OSError:
+                        pass
+            time.sleep(args.outage[1])
+            server = listen()
+            up_until = time.time() + args.outage[0]
+            log("back up")
+        server.settimeout(1)
+        try:
+            conn, address = server.accept()
+        except socket.timeout:
+            continue
+        conn.settimeout(None)
+        threading.Thread(target=serve, args=(conn, address), daemon=True).start()
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--outage", type=lambda v: tuple(int(x) for x in v.split(":")),
+                        help="UP:DOWN seconds of service and outage")
+    parser.add_argument("--drop-after", type=int, default=0, help="close a connection after this many publishes")
+    args = parser.parse_args()
+    main()
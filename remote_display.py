@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""Host sender for the remote display stream (see RemoteDisplayService.h).
+
+    remote_display.py <device ip> text "BUILD OK" --effect scroll
+    remote_display.py <device ip> spinner --seconds 3
+"""
+import argparse
+import socket
+import struct
+import time
+
+PORT = 4210
+VERSION = 1
+FRAME, TEXT, END = 0, 1, 2
+EFFECTS = ["static", "scroll", "fade", "wave", "typewriter", "reveal"]
+FRAME_LEN = 24
+INTERVAL = 0.05
+
+
+def packet(kind, sequence, payload=b""):
+    return b"VF" + struct.pack(">BBH", VERSION, kind, sequence & 0xFFFF) + payload
+
+
+def spinner_frames(count):
+    # One lit segment walking around every digit, icons off
+    for i in range(count):
+        segment = 1 << (i % 6)
+        yield bytes([0, 0, segment] * 6) + bytes(FRAME_LEN - 18)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    sub = parser.add_subparsers(dest="command", required=True)
+    text = sub.add_parser("text")
+    text.add_argument("text")
+    text.add_argument("--effect", choices=EFFECTS, default="static")
+    spinner = sub.add_parser("spinner")
+    spinner.add_argument("--seconds", type=float, default=2)
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    address = (args.host, PORT)
+    sequence = int(time.time() * 1000)
+
+    if args.command == "text":
+        payload = bytes([EFFECTS.index(args.effect)]) + args.text.encode("ascii")[:64]
+        sock.sendto(packet(TEXT, sequence, payload), address)
+    else:
+        for frame in spinner_frames(int(args.seconds / INTERVAL)):
+            sock.sendto(packet(FRAME, sequence, frame), address)
+            sequence += 1
+            time.sleep(INTERVAL)
+        sock.sendto(packet(END, sequence), address)
+
+
+if __name__ == "__main__":
+    main()
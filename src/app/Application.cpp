@@ -5,13 +5,23 @@
 #include "services/TimeService.h"
 #include "services/NetworkService.h"
 #include "services/ConfigService.h"
+#include "services/AssetSyncService.h"
+#include "services/RemoteDisplayService.h"
+#include "services/AiService.h"
+#include "services/PowerService.h"
+#include "BootSequence.h"
+#include "RemoteCommands.h"
+#include "services/WarmState.h"
 #include "states/TimeState.h"
 #include "states/MenuState.h"
 //#include "states/TextScrollState.h"
 #include "states/ConfigState.h"
+#include <menuhandler.h>
 #include <Arduino.h>
 #include <ArduinoOTA.h>
 #include <animator.h>
+#include <mqtt_manager.h>
+#include <tlspool.h>
 
 // Pin configuration
 #define KEY1 D3  // Adjust this to match your button pin
@@ -43,7 +53,8 @@ static void wifiConfigModeCallback(WiFiManager *myWiFiManager) {
 }
 
 Application::Application() 
-    : lastUpdateTime(0) {
+    : bootTimer(EventLoop::NO_TIMER),
+      stateTimer(EventLoop::NO_TIMER) {
     appInstance = this;
 }
 
@@ -54,13 +65,24 @@ Application::~Application() {
 bool Application::initialize() {
     Serial.println("\n=== Application::initialize() ===");
     
-    // Initialize display first
+    // Only what the clock needs runs here, the rest are boot stages
+    bootSequence = std::make_unique<BootSequence>();
+    eventLoop = std::make_unique<EventLoop>();
+    
+    // After a soft reset RTC memory still holds the previous run's state
+    bool warmBoot = WarmState::restore();
+    
+    // Settings first, the display needs its brightness
+    configService = std::make_unique<ConfigService>();
+    configService->begin();
+    bootSequence->mark("config");
+    
+    // Initialize display
     Serial.println("- Initializing display...");
     display = std::make_unique<VfdDisplay>();
     display->powerOn();
-    display->setBrightness(2);
-    display->setText(" BOOT");
-    globalAnimator.start_loading(0x01);
+    display->setBrightness(configService->getConfig().brightness);
+    bootSequence->mark("display");
    
     // Initialize button
     Serial.println("- Initializing button...");
@@ -73,6 +95,9 @@ bool Application::initialize() {
     // Initialize state manager early so we can use ConfigState
     Serial.println("- Initializing state manager...");
     stateManager = std::make_unique<StateManager>(this);
+    stateManager->onStateChange([this](State* state) {
+        eventLoop->restart(stateTimer, state->getUpdateInterval(), state->getUpdateInterval());
+    });
     
     // Register states
     Serial.println("- Registering states...");
@@ -87,13 +112,77 @@ bool Application::initialize() {
     
     stateManager->registerState(StateType::CONFIG, 
         std::make_unique<ConfigState>(this));
+    bootSequence->mark("states");
+    
+    // After a reset the time comes back from RTC memory, NTP follows later
+    timeService = std::make_unique<TimeService>();
+    timeService->begin();
     
-    // Initialize network service with loading animation
-    Serial.println("- Initializing network service...");
-    display->setText(" WiFi");
+    timeService->onTimeSync([this, hadTime = timeService->hasTime()]() mutable {
+        stateManager->handleTimeSync();
+        display->setIcon(DisplayIcon::CLOCK, true);
+        
+        // The pinned hosts need the clock, a sync that waited for it starts
+        if (!hadTime) {
+            hadTime = true;
+            if (networkService->isConnected()) {
+                assetSyncService->start();
+            }
+        }
+    });
     
+    // Services are created now so states can query them, they are
+    // brought up by the boot stages
     networkService = std::make_unique<NetworkService>();
     
+    // The hosts' pins, before anything connects
+    TlsPool::begin();
+    
+    // Asset sync starts once WiFi is up and the clock set, it runs from
+    // update()
+    assetSyncService = std::make_unique<AssetSyncService>();
+    assetSyncService->begin();
+    
+    assetSyncService->onProgress([](size_t done, size_t total) {
+        // Spin on more digits as the sync progresses
+        uint8_t digits = 1 + (done * 5) / total;
+        globalAnimator.start_loading((1 << digits) - 1);
+    });
+    
+    assetSyncService->onComplete([this](bool success) {
+        Serial.print("Asset sync finished: ");
+        Serial.println(success ? "OK" : "incomplete");
+        globalAnimator.stop();
+        
+        // The menu reloads its items on the next entry
+        if (assetSyncService->changedFiles() > 0) {
+            static_cast<MenuState*>(stateManager->getState(StateType::MENU))->invalidateMenu();
+        }
+        
+        // Queued behind the sync, both need the pooled TLS connection
+        aiService->prefetch(AiService::DEFAULT_PROMPT);
+    });
+    
+    // A host can take over the display with a frame stream
+    remoteDisplayService = std::make_unique<RemoteDisplayService>(display.get());
+    remoteDisplayService->onActiveChange([this](bool active) {
+        if (!active) {
+            // Let the current state draw the display from scratch
+            stateManager->changeState(stateManager->getCurrentStateType());
+        }
+    });
+    
+    // Assistant replies, answered from the LittleFS cache when possible
+    aiService = std::make_unique<AiService>(display.get(), networkService.get());
+    
+    // Night dimming, and full speed only while there is work that needs it
+    powerService = std::make_unique<PowerService>(display.get(), configService.get(), timeService.get());
+    powerService->setBusyCheck([this]() {
+        return !bootSequence->isComplete() || assetSyncService->isRunning() ||
+               aiService->isBusy() || remoteDisplayService->isActive();
+    });
+    powerService->begin();
+    
     // Set up network callbacks before begin()
     networkService->onConnectionChange([this](bool connected) {
         Serial.print("Network state changed: ");
@@ -101,6 +190,19 @@ bool Application::initialize() {
         
         stateManager->handleNetworkStateChange(connected);
         display->setIcon(DisplayIcon::WIFI, connected);
+        
+        // The AI prefetch follows once the sync is done. The asset host is
+        // pinned to its CAs, without a clock the sync starts on time sync.
+        if (connected && timeService->hasTime()) {
+            assetSyncService->start();
+        }
+    });
+    
+    // Link changes are handled on the next pass instead of the next tick
+    networkService->onLinkEvent([this]() {
+        eventLoop->post([this]() {
+            networkService->update();
+        });
     });
     
     networkService->onConfigSave([this](const NetworkService::NetworkConfig& config) {
@@ -109,69 +211,91 @@ bool Application::initialize() {
         delay(1000);
     });
     
-    // Start network service
-    networkService->begin();
-    globalAnimator.stop();
-    
-    // Initialize other services
-    Serial.println("- Initializing other services...");
+    // Resume the menu selection of the previous run. The menu itself is a
+    // press-and-hold interaction, so whatever state was active the clock
+    // comes back in the time state
+    if (warmBoot) {
+        const WarmState::Data& warmState = WarmState::previous();
+        Serial.print("- Warm boot, previous state ");
+        Serial.println(warmState.stateType);
+        
+        MenuState* menu = static_cast<MenuState*>(stateManager->getState(StateType::MENU));
+        menu->restoreSelection(warmState.menuIndex, warmState.pendingMenuIndex);
+    }
     
-    // Initialize time service after network
-    timeService = std::make_unique<TimeService>();
-    timeService->begin();
+    // Start with time display
+    Serial.println("- Starting with TIME state...");
+    stateManager->changeState(StateType::TIME);
+    bootSequence->mark("first-digits");
     
-    timeService->onTimeSync([this]() {
-        stateManager->handleTimeSync();
-        display->setIcon(DisplayIcon::CLOCK, true);
+    // Network bring-up and everything that needs it
+    using StageResult = BootSequence::StageResult;
+    BootSequence::StageId wifi = bootSequence->addStage("wifi", [this, started = false]() mutable {
+        if (!started) {
+            started = true;
+            networkService->begin();
+        }
+        // Done once connected, or when it has to wait for backoff or the portal
+        if (networkService->isConnecting()) {
+            return StageResult::PENDING;
+        }
+        if (!networkService->isConnected()) {
+            Serial.println("- No WiFi, continuing offline");
+        }
+        return StageResult::DONE;
     });
     
-    configService = std::make_unique<ConfigService>();
-    configService->begin();
+    bootSequence->addStage("ota", [this]() {
+        initializeOTA();
+        return StageResult::DONE;
+    }, BootSequence::after(wifi));
     
-    // Initialize OTA
-    initializeOTA();
+    bootSequence->addStage("remote", [this]() {
+        remoteDisplayService->begin();
+        return StageResult::DONE;
+    }, BootSequence::after(wifi));
     
-    // Show network status
-    if (networkService->isConnected()) {
-        display->setIcon(DisplayIcon::WIFI, true);
-    } else {
-        display->setText("NO WiFi");
-        delay(1000);
-    }
+    bootSequence->addStage("mqtt", [this]() {
+        initializeMqtt();
+        return StageResult::DONE;
+    }, BootSequence::after(wifi));
     
-    // Start with time display
-    Serial.println("- Starting with TIME state...");
-    stateManager->changeState(StateType::TIME);
+    // Needs the API key from the network settings, not a connection
+    bootSequence->addStage("ai", [this]() {
+        aiService->begin();
+        
+        // A sync still running or waiting for the clock prefetches when
+        // it completes
+        if (timeService->hasTime() && !assetSyncService->isRunning()) {
+            aiService->prefetch(AiService::DEFAULT_PROMPT);
+        }
+        return StageResult::DONE;
+    }, BootSequence::after(wifi));
+    
+    bootSequence->addStage("ntp", [this, requested = false]() mutable {
+        // A restored clock is good enough to finish booting, TimeService
+        // keeps trying to sync in the background
+        if (timeService->hasTime() || !networkService->isConnected()) {
+            return StageResult::DONE;
+        }
+        if (!requested) {
+            requested = timeService->syncTime();
+        }
+        return StageResult::PENDING;
+    }, BootSequence::after(wifi));
+    
+    bootSequence->addStage("assets", [this]() {
+        return assetSyncService->isRunning() ? StageResult::PENDING : StageResult::DONE;
+    }, BootSequence::after(wifi));
+    
+    initializeTimers();
     
     Serial.println("=== Application initialization complete! ===\n");
     return true;
 }
 
 void Application::update() {
-    unsigned long currentTime = millis();
-    
-    // Update button
-    button->update();
-    
-    // Handle OTA
-    ArduinoOTA.handle();
-    
-    // Update at fixed interval
-    if (currentTime - lastUpdateTime >= UPDATE_INTERVAL) {
-        lastUpdateTime = currentTime;
-        
-        // Update current state
-        stateManager->update();
-        
-        // Update services
-        if (timeService) {
-            timeService->update();
-        }
-        
-        if (networkService) {
-            networkService->update();
-        }
-    }
+    eventLoop->run();
 }
 
 void Application::onButtonPress(ButtonEvent event) {
@@ -186,6 +310,15 @@ void Application::onButtonPress(ButtonEvent event) {
         case ButtonEvent::LONG_PRESS_HOLD:
             eventName = "LONG_PRESS_HOLD";
             break;
+        case ButtonEvent::DOUBLE_PRESS:
+            eventName = "DOUBLE_PRESS";
+            break;
+        case ButtonEvent::TRIPLE_PRESS:
+            eventName = "TRIPLE_PRESS";
+            break;
+        case ButtonEvent::CLICK_HOLD:
+            eventName = "CLICK_HOLD";
+            break;
     }
     
     Serial.print("Application: Button event - ");
@@ -208,6 +341,8 @@ void Application::initializeOTA() {
         Serial.println("OTA: End");
         display->setIcon(DisplayIcon::REC, false);
         display->setText("REBOOT");
+        static_cast<MenuState*>(stateManager->getState(StateType::MENU))->getMenuHandler()->savePicker();
+        WarmState::captureTime();
         ESP.restart();
     });
     
@@ -232,6 +367,107 @@ void Application::initializeOTA() {
     ArduinoOTA.begin();
 }
 
+void Application::initializeTimers() {
+    eventLoop->addTimer("button", BUTTON_INTERVAL, [this]() {
+        button->update();
+    });
+    
+    // Network I/O that has its own pacing or reads what has arrived
+    eventLoop->addTimer("io", IO_INTERVAL, [this]() {
+        ArduinoOTA.handle();
+        if (mqttManager) {
+            mqttManager->loop();
+        }
+        remoteDisplayService->update();
+        aiService->update();
+    });
+    
+    // Bring up the remaining services
+    bootTimer = eventLoop->addTimer("boot", SERVICE_INTERVAL, [this]() {
+        bootSequence->update();
+        if (!bootSequence->isComplete()) {
+            return;
+        }
+        
+        // The timeline goes out once, retained, when the broker can take
+        // it; it is too large for the offline queue
+        if (mqttManager) {
+            if (!mqttManager->isConnected() || mqttManager->queuedMessages() > 0) {
+                return;
+            }
+            mqttManager->publish("boot", bootSequence->timelineJson().c_str(), true);
+        }
+        eventLoop->cancel(bootTimer);
+    });
+    
+    // Follows the update interval of the current state
+    unsigned long stateInterval = stateManager->getCurrentState()->getUpdateInterval();
+    stateTimer = eventLoop->addTimer("state", stateInterval, [this]() {
+        // Not while a remote stream owns the display
+        if (!remoteDisplayService->isActive()) {
+            stateManager->update();
+        }
+    });
+    
+    eventLoop->addTimer("time", TIME_INTERVAL, [this]() {
+        timeService->update();
+    });
+    
+    eventLoop->addTimer("power", POWER_INTERVAL, [this]() {
+        powerService->update();
+    });
+    
+    eventLoop->addTimer("network", SERVICE_INTERVAL, [this]() {
+        networkService->update();
+    });
+    
+    // A slice of the current asset per tick, often enough to keep up
+    // with the TCP window
+    eventLoop->addTimer("assets", IO_INTERVAL, [this]() {
+        assetSyncService->update();
+    });
+    
+    eventLoop->addTimer("config", CONFIG_INTERVAL, [this]() {
+        configService->update();
+        
+        // The record positions are batched the same way, see RecordPicker
+        static_cast<MenuState*>(stateManager->getState(StateType::MENU))->getMenuHandler()->updatePicker();
+    });
+    
+    eventLoop->addTimer("telemetry", TELEMETRY_INTERVAL, [this]() {
+        if (mqttManager) {
+            mqttManager->publishDynamic();
+            
+            // Estimated, see PowerService
+            char value[12];
+            snprintf(value, sizeof(value), "%u", powerService->estimatedMilliwatts());
+            mqttManager->publish("power-mw", value);
+            snprintf(value, sizeof(value), "%u", powerService->energyMilliwattHours());
+            mqttManager->publish("energy-mwh", value);
+        }
+    });
+    
+    eventLoop->addTimer("report", REPORT_INTERVAL, [this]() {
+        eventLoop->printReport();
+    });
+}
+
+void Application::initializeMqtt() {
+    const NetworkService::NetworkConfig& config = networkService->getConfig();
+    if (config.mqtt_server[0] == '\0') {
+        Serial.println("- No MQTT server configured");
+        return;
+    }
+    
+    Serial.println("- Initializing MQTT...");
+    mqttManager = std::make_unique<MqttManager>(config.mqtt_server, atoi(config.mqtt_port));
+    mqttManager->setCommands(RemoteCommands::COMMANDS, RemoteCommands::COMMAND_COUNT, this);
+    mqttManager->onConnectionStateChange([this](bool connected) {
+        display->setIcon(DisplayIcon::CUBE_3D, connected);
+    });
+    mqttManager->begin();
+}
+
 // Add getter implementations if not already present
 NetworkService* Application::getNetworkService() { 
     return networkService.get(); 
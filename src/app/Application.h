@@ -5,12 +5,19 @@
 #include <memory>
 #include "hal/IDisplay.h"
 #include "states/StateManager.h"
+#include "EventLoop.h"
 
 // Forward declarations
 class TimeService;
 class NetworkService;
 class ConfigService;
+class AssetSyncService;
+class RemoteDisplayService;
+class AiService;
+class PowerService;
+class BootSequence;
 class IButton;
+class MqttManager;
 
 class Application {
 private:
@@ -23,13 +30,34 @@ private:
     std::unique_ptr<TimeService> timeService;
     std::unique_ptr<NetworkService> networkService;
     std::unique_ptr<ConfigService> configService;
+    std::unique_ptr<AssetSyncService> assetSyncService;
+    std::unique_ptr<RemoteDisplayService> remoteDisplayService;
+    std::unique_ptr<AiService> aiService;
+    std::unique_ptr<PowerService> powerService;
+    std::unique_ptr<MqttManager> mqttManager; // Only with a configured broker
     
-    // Timing
-    unsigned long lastUpdateTime;
-    static constexpr unsigned long UPDATE_INTERVAL = 100; // 100ms
+    // Deferred initialization
+    std::unique_ptr<BootSequence> bootSequence;
+    
+    // Timers of the subsystems, update() runs them
+    std::unique_ptr<EventLoop> eventLoop;
+    EventLoop::TimerId bootTimer;
+    EventLoop::TimerId stateTimer;
+    
+    // Timer periods in ms
+    static constexpr unsigned long BUTTON_INTERVAL = 10;       // Debounce sampling
+    static constexpr unsigned long IO_INTERVAL = 20;           // OTA, MQTT, remote frames, AI replies, asset sync
+    static constexpr unsigned long SERVICE_INTERVAL = 100;     // Boot stages, network
+    static constexpr unsigned long TIME_INTERVAL = 1000;
+    static constexpr unsigned long POWER_INTERVAL = 1000;      // Night schedule, CPU and WiFi sleep
+    static constexpr unsigned long CONFIG_INTERVAL = 500;
+    static constexpr unsigned long TELEMETRY_INTERVAL = 60000; // 1 minute
+    static constexpr unsigned long REPORT_INTERVAL = 600000;   // 10 minutes
     
     // Private methods
     void initializeOTA();
+    void initializeMqtt();
+    void initializeTimers();
     
 public:
     Application();
@@ -44,7 +72,11 @@ public:
     TimeService* getTimeService() { return timeService.get(); }
     NetworkService* getNetworkService();
     ConfigService* getConfigService();
+    RemoteDisplayService* getRemoteDisplayService() { return remoteDisplayService.get(); }
+    AiService* getAiService() { return aiService.get(); }
+    PowerService* getPowerService() { return powerService.get(); }
     StateManager* getStateManager() { return stateManager.get(); }
+    BootSequence* getBootSequence() { return bootSequence.get(); }
     
     // Event handlers
     void onButtonPress(ButtonEvent event);
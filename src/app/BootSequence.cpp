@@ -0,0 +1,95 @@
+// app/BootSequence.cpp
+#include "BootSequence.h"
+
+BootSequence::BootSequence()
+    : doneMask(0),
+      lastMarkTime(0),
+      reported(false) {
+    entries.reserve(MAX_STAGES);
+}
+
+BootSequence::StageId BootSequence::mark(const char* name) {
+    unsigned long now = millis();
+    entries.push_back({name, nullptr, 0, lastMarkTime, now, true, true});
+    lastMarkTime = now;
+
+    StageId id = entries.size() - 1;
+    doneMask |= after(id);
+    return id;
+}
+
+BootSequence::StageId BootSequence::addStage(const char* name, StageFunction run, uint32_t dependsOn) {
+    if (entries.size() >= MAX_STAGES) {
+        Serial.printf("BootSequence: Too many stages, running %s now\n", name);
+        run();
+        return mark(name);
+    }
+    entries.push_back({name, run, dependsOn, 0, 0, false, false});
+    return entries.size() - 1;
+}
+
+void BootSequence::update() {
+    if (reported) {
+        return;
+    }
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        Entry& entry = entries[i];
+        if (entry.done || (entry.dependsOn & doneMask) != entry.dependsOn) {
+            continue;
+        }
+
+        if (!entry.started) {
+            entry.started = true;
+            entry.startTime = millis();
+            Serial.printf("BootSequence: Starting %s\n", entry.name);
+        }
+
+        if (entry.run() == StageResult::DONE) {
+            entry.done = true;
+            entry.endTime = millis();
+            doneMask |= after(i);
+            Serial.printf("BootSequence: %s done after %lu ms\n",
+                          entry.name, entry.endTime - entry.startTime);
+        }
+    }
+
+    if (isComplete()) {
+        reported = true;
+        printTimeline();
+    }
+}
+
+bool BootSequence::isComplete() const {
+    return doneMask == (1UL << entries.size()) - 1;
+}
+
+void BootSequence::printTimeline() const {
+    Serial.println("=== Boot timeline (ms since reset) ===");
+    for (const Entry& entry : entries) {
+        if (entry.done) {
+            Serial.printf("  %-12s %6lu - %6lu  (%lu ms)\n", entry.name,
+                          entry.startTime, entry.endTime, entry.endTime - entry.startTime);
+        } else {
+            Serial.printf("  %-12s %s\n", entry.name, entry.started ? "running" : "waiting");
+        }
+    }
+}
+
+String BootSequence::timelineJson() const {
+    String json = "{";
+    for (const Entry& entry : entries) {
+        if (json.length() > 1) {
+            json += ",";
+        }
+        json += "\"";
+        json += entry.name;
+        json += "\":[";
+        json += entry.startTime;
+        json += ",";
+        json += entry.done ? String(entry.endTime) : String("null");
+        json += "]";
+    }
+    json += "}";
+    return json;
+}
@@ -0,0 +1,72 @@
+// app/BootSequence.h
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <functional>
+#include <vector>
+#include <Arduino.h>
+
+// Staged boot scheduler
+//
+// Application::initialize only does what the clock needs to show digits
+// and registers everything else as a stage. Stages run from the main
+// loop once the stages they depend on are done; a stage returns PENDING
+// to be polled again on the next update, so long running work (WiFi,
+// NTP, asset sync) does not block the ones that do not need it.
+//
+// Every synchronous step and stage is timed from reset, and the
+// timeline is printed once the last stage is done. Application also
+// publishes timelineJson() on the "boot" MQTT topic.
+class BootSequence {
+public:
+    enum class StageResult {
+        DONE,
+        PENDING
+    };
+
+    using StageId = uint8_t;
+    using StageFunction = std::function<StageResult()>;
+
+    static constexpr uint8_t MAX_STAGES = 16;
+
+private:
+    struct Entry {
+        const char* name;
+        StageFunction run;
+        uint32_t dependsOn;    // Bit mask of stage ids
+        unsigned long startTime;
+        unsigned long endTime;
+        bool started;
+        bool done;
+    };
+
+    std::vector<Entry> entries;
+    uint32_t doneMask;
+    unsigned long lastMarkTime;
+    bool reported;
+
+public:
+    BootSequence();
+
+    // Record a synchronous boot step that ended now
+    StageId mark(const char* name);
+
+    // Register a stage that runs once all of `dependsOn` are done
+    StageId addStage(const char* name, StageFunction run, uint32_t dependsOn = 0);
+
+    // Dependency mask for a stage id
+    static uint32_t after(StageId id) { return 1UL << id; }
+
+    // Run the stages that are ready (call from main loop)
+    void update();
+
+    bool isComplete() const;
+
+    // Print the timeline to Serial
+    void printTimeline() const;
+
+    // Timeline as JSON, {"stage": [start, end], ...} in ms since reset
+    String timelineJson() const;
+};
+
+#endif // BOOT_SEQUENCE_H
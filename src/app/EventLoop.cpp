@@ -0,0 +1,264 @@
+// app/EventLoop.cpp
+#include "EventLoop.h"
+#include <coredecls.h>
+
+// Whole ticks for a duration, at least one
+static uint32_t ticksFor(unsigned long ms) {
+    return max<uint32_t>(1, (ms + EventLoop::TICK - 1) / EventLoop::TICK);
+}
+
+EventLoop::EventLoop()
+    : currentTick(0),
+      tickMillis(millis()),
+      eventHead(0),
+      eventCount(0),
+      droppedEvents(0),
+      windowStart(millis()),
+      sleptMillis(0) {
+    for (uint8_t wheel = 0; wheel < LEVELS; wheel++) {
+        for (uint8_t slot = 0; slot < SLOTS; slot++) {
+            slots[wheel][slot] = NO_TIMER;
+        }
+    }
+    for (Timer& timer : timers) {
+        timer.used = false;
+        timer.armed = false;
+        timer.queued = false;
+    }
+}
+
+EventLoop::TimerId EventLoop::addTimer(const char* name, unsigned long interval, Callback callback, unsigned long delay) {
+    for (TimerId id = 0; id < MAX_TIMERS; id++) {
+        Timer& timer = timers[id];
+        if (timer.used) {
+            continue;
+        }
+        timer.name = name;
+        timer.callback = callback;
+        timer.used = true;
+        timer.runs = 0;
+        timer.overruns = 0;
+        timer.maxLate = 0;
+        timer.maxRun = 0;
+        restart(id, delay ? delay : interval, interval);
+        return id;
+    }
+    Serial.printf("EventLoop: Too many timers, %s not added\n", name);
+    return NO_TIMER;
+}
+
+void EventLoop::restart(TimerId id, unsigned long delay, unsigned long interval) {
+    if (id == NO_TIMER) {
+        return;
+    }
+    timers[id].interval = interval ? ticksFor(interval) : 0;
+    restart(id, delay);
+}
+
+void EventLoop::restart(TimerId id, unsigned long delay) {
+    if (id == NO_TIMER) {
+        return;
+    }
+    Timer& timer = timers[id];
+    unlink(id);
+    timer.expires = nowTick() + ticksFor(delay);
+    timer.armed = true;
+    insert(id);
+}
+
+void EventLoop::cancel(TimerId id) {
+    if (id == NO_TIMER) {
+        return;
+    }
+    unlink(id);
+    timers[id].armed = false;
+}
+
+bool EventLoop::post(Callback callback) {
+    if (eventCount == MAX_EVENTS) {
+        droppedEvents++;
+        return false;
+    }
+    events[(eventHead + eventCount) % MAX_EVENTS] = callback;
+    eventCount++;
+
+    // Cut a sleep in run() short
+    esp_schedule();
+    return true;
+}
+
+void EventLoop::run() {
+    runEvents();
+    advance();
+
+    unsigned long sleep = sleepTime();
+    if (sleep == 0) {
+        // Still let the SDK run
+        yield();
+        return;
+    }
+
+    // Woken early by post()
+    unsigned long start = millis();
+    esp_delay(sleep, [this]() { return eventCount == 0; }, sleep);
+    sleptMillis += millis() - start;
+}
+
+void EventLoop::printReport() {
+    unsigned long now = millis();
+    unsigned long window = max(now - windowStart, 1UL);
+    Serial.printf("=== Event loop: %lu%% busy over %lu s, %u events dropped ===\n",
+                  100 - min(sleptMillis * 100 / window, 100UL), window / 1000, droppedEvents);
+    for (Timer& timer : timers) {
+        if (!timer.used) {
+            continue;
+        }
+        Serial.printf("  %-10s %6lu ms %6u runs %4u overruns  late %4u ms  run %4u ms\n",
+                      timer.name, timer.interval * TICK, timer.runs, timer.overruns,
+                      timer.maxLate, timer.maxRun);
+        timer.runs = 0;
+        timer.overruns = 0;
+        timer.maxLate = 0;
+        timer.maxRun = 0;
+    }
+    windowStart = now;
+    sleptMillis = 0;
+    droppedEvents = 0;
+}
+
+// Run the ticks that have passed, catching up after a long callback
+void EventLoop::advance() {
+    while (millis() - tickMillis >= TICK) {
+        tickMillis += TICK;
+        currentTick++;
+
+        // Bring the timers of the next turn down from the coarser wheels
+        if ((currentTick & SLOT_MASK) == 0) {
+            if (((currentTick >> SLOT_BITS) & SLOT_MASK) == 0) {
+                cascade(2);
+            }
+            cascade(1);
+        }
+
+        TimerId& head = slots[0][currentTick & SLOT_MASK];
+        while (head != NO_TIMER) {
+            TimerId id = head;
+            unlink(id);
+            runTimer(id);
+        }
+    }
+}
+
+void EventLoop::runEvents() {
+    // Events posted by these run on the next pass
+    for (uint8_t count = eventCount; count > 0; count--) {
+        Callback callback = std::move(events[eventHead]);
+        events[eventHead] = nullptr;
+        eventHead = (eventHead + 1) % MAX_EVENTS;
+        eventCount--;
+        callback();
+    }
+}
+
+void EventLoop::runTimer(TimerId id) {
+    Timer& timer = timers[id];
+    unsigned long start = millis();
+    timer.maxLate = max<uint32_t>(timer.maxLate, start - tickMillis);
+
+    if (timer.interval == 0) {
+        timer.armed = false;
+    }
+    timer.callback();
+    timer.runs++;
+    timer.maxRun = max<uint32_t>(timer.maxRun, millis() - start);
+
+    // Re-arm from the deadline, unless the callback did already
+    if (!timer.armed || timer.queued) {
+        return;
+    }
+    timer.expires += timer.interval;
+    uint32_t now = nowTick();
+    if ((int32_t)(timer.expires - now) < 0) {
+        uint32_t missed = (now - timer.expires + timer.interval - 1) / timer.interval;
+        timer.overruns += missed;
+        timer.expires += missed * timer.interval;
+    }
+    insert(id);
+}
+
+void EventLoop::insert(TimerId id) {
+    Timer& timer = timers[id];
+    // Due in the current tick only when cascading, its slot runs next
+    int32_t delta = timer.expires - currentTick;
+    if (delta < 0) {
+        timer.expires = currentTick + 1;
+        delta = 1;
+    }
+
+    // Beyond the coarsest wheel: park in its last slot, the timer comes
+    // back through here when that slot cascades
+    uint32_t expires = timer.expires;
+    if ((uint32_t)delta >= WHEEL_SPAN) {
+        expires = currentTick + WHEEL_SPAN - 1;
+        delta = WHEEL_SPAN - 1;
+    }
+
+    uint8_t wheel = 0;
+    while (wheel < LEVELS - 1 && (uint32_t)delta >= (1UL << (SLOT_BITS * (wheel + 1)))) {
+        wheel++;
+    }
+    uint8_t slot = (expires >> (SLOT_BITS * wheel)) & SLOT_MASK;
+
+    timer.wheel = wheel;
+    timer.slot = slot;
+    timer.next = slots[wheel][slot];
+    timer.queued = true;
+    slots[wheel][slot] = id;
+}
+
+void EventLoop::unlink(TimerId id) {
+    Timer& timer = timers[id];
+    if (!timer.queued) {
+        return;
+    }
+    TimerId* link = &slots[timer.wheel][timer.slot];
+    while (*link != id) {
+        link = &timers[*link].next;
+    }
+    *link = timer.next;
+    timer.queued = false;
+}
+
+// Move the timers of the current slot of `wheel` to finer wheels
+void EventLoop::cascade(uint8_t wheel) {
+    TimerId& head = slots[wheel][(currentTick >> (SLOT_BITS * wheel)) & SLOT_MASK];
+    TimerId id = head;
+    head = NO_TIMER;
+    while (id != NO_TIMER) {
+        TimerId next = timers[id].next;
+        timers[id].queued = false;
+        insert(id);
+        id = next;
+    }
+}
+
+// The tick millis() is in, currentTick lags behind it while catching up
+uint32_t EventLoop::nowTick() const {
+    return currentTick + (millis() - tickMillis) / TICK;
+}
+
+unsigned long EventLoop::sleepTime() const {
+    if (eventCount > 0) {
+        return 0;
+    }
+
+    uint32_t nearest = WHEEL_SPAN;
+    for (const Timer& timer : timers) {
+        if (timer.queued) {
+            nearest = min<uint32_t>(nearest, timer.expires - currentTick);
+        }
+    }
+
+    long remaining = (long)(nearest * TICK) - (long)(millis() - tickMillis);
+    return constrain(remaining, 0L, (long)MAX_SLEEP);
+}
@@ -0,0 +1,117 @@
+// app/EventLoop.h
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <functional>
+#include <Arduino.h>
+
+// Timers and deferred events for the main loop
+//
+// Every subsystem registers a timer with its own period instead of
+// comparing millis() on each pass. Timers live in a hierarchical timer
+// wheel: LEVELS wheels of SLOTS slots, the first one TICK ms per slot and
+// each further one SLOTS times coarser. A timer sits in the finest wheel
+// that reaches its deadline and moves down a level when the wheel above
+// turns over, so only the timers due in the current tick are touched.
+//
+// Periodic timers are re-armed from their deadline, not from the time
+// they ran, so they do not drift. A timer that falls a whole period
+// behind skips the missed runs; these overruns, the worst lateness and
+// the longest run are kept per timer for printReport().
+//
+// Between passes run() sleeps until the next deadline. post() queues a
+// callback for the next pass and wakes a sleeping loop early; it may be
+// called from SDK callbacks, but not from interrupts.
+class EventLoop {
+public:
+    using TimerId = uint8_t;
+    using Callback = std::function<void()>;
+
+    static constexpr TimerId NO_TIMER = 0xFF;
+    static constexpr uint8_t MAX_TIMERS = 16;
+    static constexpr uint8_t MAX_EVENTS = 8;
+    static constexpr unsigned long TICK = 10;        // ms per slot of the finest wheel
+    static constexpr unsigned long MAX_SLEEP = 1000; // Longest sleep between passes
+
+private:
+    static constexpr uint8_t LEVELS = 3;
+    static constexpr uint8_t SLOT_BITS = 5;
+    static constexpr uint8_t SLOTS = 1 << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint32_t WHEEL_SPAN = 1UL << (LEVELS * SLOT_BITS); // Ticks
+
+    struct Timer {
+        const char* name;
+        Callback callback;
+        uint32_t interval;      // Ticks, 0 for a one-shot timer
+        uint32_t expires;       // Tick of the next run
+        TimerId next;           // Next timer in the same slot
+        uint8_t wheel;          // Slot list it is queued in
+        uint8_t slot;
+        bool used;
+        bool armed;             // Due to run, set by restart()
+        bool queued;            // In a slot list
+
+        // Statistics since the last report
+        uint32_t runs;
+        uint32_t overruns;      // Periods skipped because it ran too late
+        uint32_t maxLate;       // ms after the deadline
+        uint32_t maxRun;        // ms spent in the callback
+    };
+
+    Timer timers[MAX_TIMERS];
+    TimerId slots[LEVELS][SLOTS];
+
+    // Ticks are counted from millis() deltas, so they do not jump when
+    // millis() wraps
+    uint32_t currentTick;       // Last tick whose timers ran
+    unsigned long tickMillis;   // millis() at the start of currentTick
+
+    Callback events[MAX_EVENTS];
+    uint8_t eventHead;
+    uint8_t eventCount;
+    uint8_t droppedEvents;
+
+    // Load accounting since the last report
+    unsigned long windowStart;
+    unsigned long sleptMillis;
+
+public:
+    EventLoop();
+
+    // Register a timer, first due after `delay` ms (the interval if 0).
+    // An `interval` of 0 makes a one-shot timer, it stays registered and
+    // can be armed again with restart().
+    TimerId addTimer(const char* name, unsigned long interval, Callback callback, unsigned long delay = 0);
+
+    // Run a timer after `delay` ms, then every `interval` ms
+    void restart(TimerId id, unsigned long delay, unsigned long interval);
+
+    // Same with the timer's current interval
+    void restart(TimerId id, unsigned long delay);
+
+    // Stop a timer until the next restart()
+    void cancel(TimerId id);
+
+    // Run `callback` on the next pass
+    bool post(Callback callback);
+
+    // Run the pending events and due timers, then sleep until the next
+    // deadline or event (call from loop())
+    void run();
+
+    // Per timer statistics and the busy share of the loop, then reset them
+    void printReport();
+
+private:
+    void advance();
+    void runEvents();
+    void runTimer(TimerId id);
+    void insert(TimerId id);
+    void unlink(TimerId id);
+    void cascade(uint8_t wheel);
+    uint32_t nowTick() const;
+    unsigned long sleepTime() const;
+};
+
+#endif // EVENT_LOOP_H
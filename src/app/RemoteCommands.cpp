@@ -0,0 +1,171 @@
+// app/RemoteCommands.cpp
+#include "RemoteCommands.h"
+#include "Application.h"
+#include "services/AiService.h"
+#include "services/ConfigService.h"
+#include "services/PowerService.h"
+#include "services/RemoteDisplayService.h"
+#include "states/MenuState.h"
+#include <Arduino.h>
+#include <animator.h>
+
+extern Animator globalAnimator;
+
+namespace {
+
+// Remote text, the animator borrows it while scrolling
+char remoteText[MQTT_QUEUE_PAYLOAD_MAX] = "VFD";
+
+// Copy a payload into remoteText, which the caller has stopped using
+void setRemoteText(const char* payload, size_t length) {
+    length = min(length, sizeof(remoteText) - 1);
+    memcpy(remoteText, payload, length);
+    remoteText[length] = '\0';
+}
+
+// Parse an unsigned decimal, the whole payload must be digits
+bool parseNumber(const char* payload, size_t length, uint32_t& value) {
+    if (length == 0 || length > 5) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (payload[i] < '0' || payload[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (payload[i] - '0');
+    }
+    return true;
+}
+
+using Effect = void (Animator::*)(const char*, uint8_t, std::function<void()>, unsigned long);
+
+struct EffectInfo {
+    const char* name;
+    Effect start;
+    uint8_t frame;
+};
+
+const EffectInfo EFFECTS[] = {
+    {"fade", &Animator::start_fade_in, 120},
+    {"fadeout", &Animator::start_fade_out, 120},
+    {"random", &Animator::start_random_fade_in, 50},
+    {"reveal", &Animator::start_reveal_effect, 150},
+    {"typewriter", &Animator::start_typewriter_effect, 200},
+    {"wave", &Animator::start_wave_effect, 100},
+};
+
+void onAi(void* context, const char* payload, size_t length) {
+    Application* app = static_cast<Application*>(context);
+    char prompt[AiService::PROMPT_MAX + 1];
+    length = min(length, sizeof(prompt) - 1);
+    memcpy(prompt, payload, length);
+    prompt[length] = '\0';
+    app->getAiService()->ask(length > 0 ? prompt : AiService::DEFAULT_PROMPT,
+                             app->getConfigService()->getConfig().scrollFrame);
+}
+
+void onAnimation(void* context, const char* payload, size_t length) {
+    const char* separator = static_cast<const char*>(memchr(payload, ':', length));
+    size_t nameLength = separator ? separator - payload : length;
+
+    for (const EffectInfo& effect : EFFECTS) {
+        if (strlen(effect.name) != nameLength || strncmp(effect.name, payload, nameLength) != 0) {
+            continue;
+        }
+        globalAnimator.stop();
+        if (separator) {
+            setRemoteText(separator + 1, length - nameLength - 1);
+        }
+        // Without a text the effect replays the last remote text
+        (globalAnimator.*effect.start)(remoteText, effect.frame, nullptr, 0);
+        return;
+    }
+    Serial.printf("RemoteCommands: Unknown animation %.*s\n", (int)nameLength, payload);
+}
+
+void onBrightness(void* context, const char* payload, size_t length) {
+    Application* app = static_cast<Application*>(context);
+    uint32_t level;
+    if (!parseNumber(payload, length, level) || level > 7) {
+        Serial.println("RemoteCommands: Brightness must be 0-7");
+        return;
+    }
+    // At night this is the night level
+    app->getPowerService()->setBrightness(level);
+}
+
+void onFrame(void* context, const char* payload, size_t length) {
+    Application* app = static_cast<Application*>(context);
+    app->getRemoteDisplayService()->receive(reinterpret_cast<const uint8_t*>(payload), length);
+}
+
+void onMenu(void* context, const char* payload, size_t length) {
+    Application* app = static_cast<Application*>(context);
+    uint32_t index;
+    MenuState* menu = static_cast<MenuState*>(app->getStateManager()->getState(StateType::MENU));
+    if (!parseNumber(payload, length, index) || index >= 255 || !menu->selectItem(index)) {
+        Serial.println("RemoteCommands: No such menu item");
+        return;
+    }
+    menu->executeSelectedAction();
+}
+
+void onNight(void* context, const char* payload, size_t length) {
+    Application* app = static_cast<Application*>(context);
+    
+    // <start hour> <end hour> <level>, PowerService picks it up
+    uint32_t values[3];
+    uint8_t count = 0;
+    while (count < 3) {
+        const char* end = static_cast<const char*>(memchr(payload, ' ', length));
+        size_t fieldLength = end ? end - payload : length;
+        if (!parseNumber(payload, fieldLength, values[count])) {
+            break;
+        }
+        count++;
+        if (!end) {
+            break;
+        }
+        length -= fieldLength + 1;
+        payload = end + 1;
+    }
+    if (count != 3 || values[0] > 23 || values[1] > 23 || values[2] > 7) {
+        Serial.println("RemoteCommands: Night must be <start 0-23> <end 0-23> <level 0-7>");
+        return;
+    }
+    
+    ConfigService::Config config = app->getConfigService()->getConfig();
+    config.nightStart = values[0];
+    config.nightEnd = values[1];
+    config.nightBrightness = values[2];
+    app->getConfigService()->setConfig(config);
+}
+
+void onText(void* context, const char* payload, size_t length) {
+    Application* app = static_cast<Application*>(context);
+    globalAnimator.stop();
+    setRemoteText(payload, length);
+    app->getDisplay()->setIcon(DisplayIcon::PLAY, true);
+    globalAnimator.set_segments_and_run(remoteText, nullptr,
+                                        app->getConfigService()->getConfig().scrollFrame);
+}
+
+} // namespace
+
+namespace RemoteCommands {
+
+// Sorted by name, MqttManager looks commands up by binary search
+constexpr MqttCommand COMMANDS[] = {
+    {"ai", onAi},
+    {"animation", onAnimation},
+    {"brightness", onBrightness},
+    {"frame", onFrame},
+    {"menu", onMenu},
+    {"night", onNight},
+    {"text", onText},
+};
+constexpr size_t COMMAND_COUNT = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+static_assert(mqttCommandsSorted(COMMANDS, COMMAND_COUNT), "Remote commands must be sorted by name");
+
+} // namespace RemoteCommands
@@ -0,0 +1,23 @@
+// app/RemoteCommands.h
+#ifndef REMOTE_COMMANDS_H
+#define REMOTE_COMMANDS_H
+
+#include <mqtt_manager.h>
+
+// Commands accepted on vfd/<chip id>/cmd/<name>
+//
+//   ai         [<prompt>]         Assistant reply, cached replies show at once
+//   animation  <effect>[:<text>]  fade, fadeout, random, reveal, typewriter, wave
+//   brightness <0-7>              Dimming level, saved to the settings
+//   frame      <binary packet>    Remote display stream, see RemoteDisplayService
+//   menu       <index>            Show menu item <index>
+//   night      <from> <to> <0-7>  Night hours and their dimming level, saved
+//   text       <text>             Scroll a text once
+//
+// Handlers are called with the Application as context.
+namespace RemoteCommands {
+    extern const MqttCommand COMMANDS[];
+    extern const size_t COMMAND_COUNT;
+}
+
+#endif // REMOTE_COMMANDS_H
@@ -5,7 +5,7 @@
 #include <Arduino.h>
 
 ConfigState::ConfigState(Application* application) 
-    : State(application), lastUpdateTime(0), scrollPosition(0) {
+    : State(application), scrollPosition(0) {
 }
 
 void ConfigState::onEnter() {
@@ -20,7 +20,6 @@ void ConfigState::onEnter() {
     app->getDisplay()->setIcon(DisplayIcon::WIFI, true);
     
     scrollPosition = 0;
-    lastUpdateTime = millis();
 }
 
 void ConfigState::onExit() {
@@ -28,41 +27,35 @@ void ConfigState::onExit() {
 }
 
 void ConfigState::onUpdate() {
-    unsigned long currentTime = millis();
-    
-    // Scroll the password every 300ms if it's longer than 6 chars
-    if (currentTime - lastUpdateTime >= 300) {
-        lastUpdateTime = currentTime;
+    // Scroll the password if it's longer than 6 chars
+    if (password.length() > 6) {
+        // Create a scrolling display of the password
+        std::string displayText = password + "   "; // Add spaces for gap
+        
+        // Calculate the visible portion
+        std::string visible = displayText.substr(scrollPosition, 6);
         
-        if (password.length() > 6) {
-            // Create a scrolling display of the password
-            std::string displayText = password + "   "; // Add spaces for gap
-            
-            // Calculate the visible portion
-            std::string visible = displayText.substr(scrollPosition, 6);
-            
-            // If we need more characters, wrap around
-            if (visible.length() < 6) {
-                visible += displayText.substr(0, 6 - visible.length());
-            }
-            
-            app->getDisplay()->setText(visible.c_str());
-            
-            // Update scroll position
-            scrollPosition++;
-            if (scrollPosition >= displayText.length()) {
-                scrollPosition = 0;
-            }
-        } else {
-            // Password fits on display
-            app->getDisplay()->setText(password.c_str());
+        // If we need more characters, wrap around
+        if (visible.length() < 6) {
+            visible += displayText.substr(0, 6 - visible.length());
         }
         
-        // Toggle WiFi icon for visual feedback
-        static bool wifiIconState = true;
-        wifiIconState = !wifiIconState;
-        app->getDisplay()->setIcon(DisplayIcon::WIFI, wifiIconState);
+        app->getDisplay()->setText(visible.c_str());
+        
+        // Update scroll position
+        scrollPosition++;
+        if (scrollPosition >= displayText.length()) {
+            scrollPosition = 0;
+        }
+    } else {
+        // Password fits on display
+        app->getDisplay()->setText(password.c_str());
     }
+    
+    // Toggle WiFi icon for visual feedback
+    static bool wifiIconState = true;
+    wifiIconState = !wifiIconState;
+    app->getDisplay()->setIcon(DisplayIcon::WIFI, wifiIconState);
 }
 
 void ConfigState::onButtonEvent(ButtonEvent event) {
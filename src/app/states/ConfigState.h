@@ -8,7 +8,6 @@
 class ConfigState : public State {
 private:
     std::string password;
-    unsigned long lastUpdateTime;
     int scrollPosition;
     
 public:
@@ -17,6 +16,7 @@ public:
     void onEnter() override;
     void onExit() override;
     void onUpdate() override;
+    unsigned long getUpdateInterval() const override { return 300; } // Password scroll step
     void onButtonEvent(ButtonEvent event) override;
     
     StateType getType() const override { return StateType::CONFIG; }
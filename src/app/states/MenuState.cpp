@@ -2,7 +2,11 @@
 #include "MenuState.h"
 #include "app/Application.h"
 #include "services/NetworkService.h"
+#include "services/ConfigService.h"
+#include "services/AiService.h"
+#include "services/WarmState.h"
 #include "menuhandler.h"
+#include "recordstore.h"
 #include "animator.h"
 #include <Arduino.h>
 #include <LittleFS.h>
@@ -11,8 +15,13 @@
 extern Animator globalAnimator;
 
 MenuState::MenuState(Application* application) 
-    : State(application), lastScrollTime(0), isScrolling(false) {
+    : State(application), resumeMenuIndex(0) {
     menuHandler = std::make_unique<MenuHandler>();
+    
+    // Non-file menu items are handled here
+    menuHandler->setSpecialActionCallback([this](const char* item) {
+        onSpecialAction(item);
+    });
 }
 
 MenuState::~MenuState() = default;
@@ -20,16 +29,16 @@ MenuState::~MenuState() = default;
 void MenuState::onEnter() {
     Serial.println("MenuState: Entering menu");
     
-    // Initialize menu handler if needed
-    if (!menuHandler->begin()) {
+    // A running record scroll borrows text from the menu items
+    globalAnimator.stop();
+    
+    // Items are loaded on the first entry and after the assets changed
+    if (!loadMenu()) {
         Serial.println("MenuState: Failed to initialize menu handler");
         app->getDisplay()->setText("NO MENU");
         return;
     }
     
-    // Load menu items from data.json
-    menuHandler->initializeMenuItems();
-    
     // Check if menu items were loaded
     if (menuHandler->getMenuItems().empty()) {
         Serial.println("MenuState: No menu items loaded");
@@ -39,67 +48,21 @@ void MenuState::onEnter() {
         return;
     }
     
-    // Set up special action callback for non-file menu items
-    menuHandler->setSpecialActionCallback([this](const char* item) {
-        Serial.print("MenuState: Special action - ");
-        Serial.println(item);
-        
-        if (strcmp(item, "update") == 0) {
-            app->getDisplay()->setText("UPDATE");
-            delay(1000);
-            // Clear all files in LittleFS
-            Dir dir = LittleFS.openDir("/");
-            while (dir.next()) {
-                String fileName = dir.fileName();
-                Serial.print("Deleting file: ");
-                Serial.println(fileName);
-                LittleFS.remove(fileName);
-            }
-            ESP.restart();
-        }
-        else if (strcmp(item, "config") == 0) {
-            app->getDisplay()->setText("CONFIG");
-            delay(1000);
-            // Reset WiFi settings and restart
-            app->getNetworkService()->resetSettings();
-            ESP.restart();
-        }
-        else if (strcmp(item, "ai") == 0) {
-            // AI menu item - will implement AI state later
-            app->getDisplay()->setText("AI");
-            delay(1000);
-        }
-        else if (strcmp(item, "demo") == 0) {
-            // Start animation demo
-            Serial.println("Starting fade demo...");
-            globalAnimator.stop();
-            startFadeDemo();
-        }
-    });
+    // Start from the top, or where the previous run left off
+    menuHandler->setCurrentMenuIndex(resumeMenuIndex);
+    resumeMenuIndex = 0;
     
-    // Display first menu item
+    // Display first menu item, the button hold repeats scroll from there
     displayCurrentMenuItem();
-    
-    // Start scrolling immediately when entering menu via long press
-    isScrolling = true;
-    lastScrollTime = millis();
 }
 
 void MenuState::onExit() {
     Serial.println("MenuState: Exiting menu");
-    isScrolling = false;
     globalAnimator.stop(); // Stop any ongoing animation
 }
 
 void MenuState::onUpdate() {
-    // Auto-scroll through menu items while button is held
-    if (isScrolling) {
-        unsigned long currentTime = millis();
-        if (currentTime - lastScrollTime >= SCROLL_INTERVAL) {
-            lastScrollTime = currentTime;
-            scrollToNext();
-        }
-    }
+    // Scrolling follows the button's hold repeats, see onButtonEvent()
 }
 
 void MenuState::onButtonEvent(ButtonEvent event) {
@@ -113,12 +76,12 @@ void MenuState::onButtonEvent(ButtonEvent event) {
     else if (event == ButtonEvent::LONG_PRESS) {
         // Long press released - stop scrolling and flash selected item
         Serial.println("MenuState: Long press released - flashing and saving selection");
-        isScrolling = false;
         
         // Save the selected index as pending
         menuHandler->pendingMenuIndex = menuHandler->getCurrentMenuIndex();
         Serial.print("MenuState: Saved pending index: ");
         Serial.println(menuHandler->pendingMenuIndex);
+        saveWarmSelection();
         
         // Flash the selected item
         flashMenuItem();
@@ -127,9 +90,9 @@ void MenuState::onButtonEvent(ButtonEvent event) {
         app->getStateManager()->changeState(StateType::TIME);
     }
     else if (event == ButtonEvent::LONG_PRESS_HOLD) {
-        // Continue scrolling while button is held
-        // This keeps the scrolling active
-        isScrolling = true;
+        // One item per repeat; the repeats speed up the longer the
+        // button is held, so long menus are quick to get through
+        scrollToNext();
     }
 }
 
@@ -152,6 +115,7 @@ void MenuState::displayCurrentMenuItem() {
 
 void MenuState::scrollToNext() {
     String nextItem = menuHandler->scrollToNextItem();
+    saveWarmSelection();
     Serial.print("MenuState: Scrolled to: ");
     Serial.println(nextItem);
     app->getDisplay()->setText(nextItem.c_str());
@@ -192,10 +156,12 @@ void MenuState::executeSelectedAction() {
     // Set current index to the pending selection
     menuHandler->setCurrentMenuIndex(menuHandler->pendingMenuIndex);
     
-    // Execute the action
-    String result = menuHandler->selectCurrentItem();
+    // Execute the action; the record is decoded into a static buffer
+    // and handed to the animator as is, so nothing is allocated here
+    static char recordBuffer[RECORD_MAX_LENGTH + 1];
+    const char* intro = menuHandler->selectCurrentItem(recordBuffer, sizeof(recordBuffer));
     
-    if (result.length() > 0) {
+    if (intro) {
         // Text to display - use animator
         globalAnimator.stop();
         app->getDisplay()->setIcon(DisplayIcon::PLAY, true);
@@ -205,11 +171,110 @@ void MenuState::executeSelectedAction() {
             // to clear the PLAY icon and return to the appropriate state
         });
         
-        globalAnimator.set_text_and_run(result.c_str(), 210);
+        globalAnimator.set_segments_and_run(intro, recordBuffer, app->getConfigService()->getConfig().scrollFrame);
     }
     
     // Clear the pending action
     menuHandler->clearPendingAction();
+    saveWarmSelection();
+}
+
+void MenuState::restoreSelection(uint8_t index, uint8_t pendingIndex) {
+    // Only record selections come back; a special action such as
+    // "config" must not run again from a press after the reboot it caused
+    if (pendingIndex != 255 && selectItem(pendingIndex)) {
+        const String& type = menuHandler->getMenuItems()[pendingIndex].type;
+        if (type != "file" && type != "random") {
+            menuHandler->clearPendingAction();
+        }
+    }
+    resumeMenuIndex = index;
+    WarmState::setMenuSelection(index, menuHandler->pendingMenuIndex);
+}
+
+bool MenuState::selectItem(uint8_t index) {
+    // A selection refers to the loaded items, which must not be
+    // downloaded here
+    if (!menuHandler->isLoaded() && !LittleFS.exists(DATA_FILENAME)) {
+        return false;
+    }
+    if (!loadMenu()) {
+        return false;
+    }
+    menuHandler->pendingMenuIndex = index;
+    if (!menuHandler->hasPendingAction()) {
+        menuHandler->clearPendingAction();
+        return false;
+    }
+    return true;
+}
+
+void MenuState::invalidateMenu() {
+    menuHandler->invalidate();
+}
+
+bool MenuState::loadMenu() {
+    if (menuHandler->isLoaded()) {
+        return true;
+    }
+    if (!menuHandler->begin()) {
+        return false;
+    }
+    
+    // A record scroll may still show text of the items replaced here
+    globalAnimator.stop();
+    menuHandler->initializeMenuItems();
+    return menuHandler->isLoaded();
+}
+
+void MenuState::onSpecialAction(const char* item) {
+    Serial.print("MenuState: Special action - ");
+    Serial.println(item);
+    
+    if (strcmp(item, "update") == 0) {
+        app->getDisplay()->setText("UPDATE");
+        delay(1000);
+        // Clear the assets; the settings and the record positions are
+        // not content and stay
+        Dir dir = LittleFS.openDir("/");
+        while (dir.next()) {
+            String fileName = dir.fileName();
+            if (ConfigService::isSettingsFile(fileName) || fileName == PICKER_STATE_FILENAME + 1) {
+                continue;
+            }
+            Serial.print("Deleting file: ");
+            Serial.println(fileName);
+            LittleFS.remove(fileName);
+        }
+        WarmState::setMenuSelection(menuHandler->getCurrentMenuIndex(), 255);
+        WarmState::captureTime();
+        ESP.restart();
+    }
+    else if (strcmp(item, "config") == 0) {
+        app->getDisplay()->setText("CONFIG");
+        delay(1000);
+        // Reset WiFi settings and restart
+        app->getNetworkService()->resetSettings();
+        menuHandler->savePicker();
+        WarmState::setMenuSelection(menuHandler->getCurrentMenuIndex(), 255);
+        WarmState::captureTime();
+        ESP.restart();
+    }
+    else if (strcmp(item, "ai") == 0) {
+        // A cached reply shows at once, a fresh one is fetched meanwhile
+        app->getAiService()->ask(AiService::DEFAULT_PROMPT,
+                                 app->getConfigService()->getConfig().scrollFrame);
+    }
+    else if (strcmp(item, "demo") == 0) {
+        // Start animation demo
+        Serial.println("Starting fade demo...");
+        globalAnimator.stop();
+        startFadeDemo();
+    }
+}
+
+void MenuState::saveWarmSelection() {
+    WarmState::setMenuSelection(menuHandler->getCurrentMenuIndex(), menuHandler->pendingMenuIndex);
 }
 
 void MenuState::startFadeDemo() {
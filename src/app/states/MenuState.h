@@ -11,9 +11,7 @@ class MenuHandler;
 class MenuState : public State {
 private:
     std::unique_ptr<MenuHandler> menuHandler;
-    unsigned long lastScrollTime;
-    bool isScrolling;
-    static constexpr unsigned long SCROLL_INTERVAL = 800; // ms between menu items
+    uint8_t resumeMenuIndex; // Cursor to start from on the next entry
     
 public:
     explicit MenuState(Application* app);
@@ -31,14 +29,27 @@ public:
     bool hasPendingAction() const;
     void executeSelectedAction();
     
+    // Restore the cursor and pending selection of the previous run
+    void restoreSelection(uint8_t index, uint8_t pendingIndex);
+    
+    // Make item `index` the pending selection, loading the items from
+    // flash if needed. False if there is no such item.
+    bool selectItem(uint8_t index);
+    
+    // The assets changed, reload the items on the next use
+    void invalidateMenu();
+    
     // Get menu handler for external access (if needed)
     MenuHandler* getMenuHandler() { return menuHandler.get(); }
     
 private:
+    bool loadMenu();
+    void onSpecialAction(const char* item);
     void displayCurrentMenuItem();
     void scrollToNext();
     void flashMenuItem();
     void startFadeDemo();
+    void saveWarmSelection();
 };
 
 #endif // MENU_STATE_H
\ No newline at end of file
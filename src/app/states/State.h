@@ -13,13 +13,17 @@ enum class StateType {
     TEXT_SCROLL,
     AI_CHAT,
     CONFIG,
-    NO_TIME
+    NO_TIME,
+    COUNT       // Number of state types, keep last
 };
 
 enum class ButtonEvent {
     SHORT_PRESS,
     LONG_PRESS,
-    LONG_PRESS_HOLD
+    LONG_PRESS_HOLD,
+    DOUBLE_PRESS,
+    TRIPLE_PRESS,
+    CLICK_HOLD
 };
 
 class State {
@@ -35,6 +39,9 @@ public:
     virtual void onExit() = 0;
     virtual void onUpdate() = 0;
     
+    // Period of onUpdate() calls in ms while the state is current
+    virtual unsigned long getUpdateInterval() const { return 100; }
+    
     // Event handlers
     virtual void onButtonEvent(ButtonEvent event) = 0;
     virtual void onNetworkStateChange(bool connected) {}
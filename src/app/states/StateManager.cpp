@@ -1,9 +1,15 @@
 // app/states/StateManager.cpp
 #include "StateManager.h"
+#include "services/WarmState.h"
 #include <Arduino.h> // for Serial
 
-StateManager::StateManager(Application* application) 
-    : app(application), currentState(nullptr) {
+// Switches made by the states and the application
+static_assert(StateManager::canTransition(StateType::TIME, StateType::MENU), "Menu entry");
+static_assert(StateManager::canTransition(StateType::MENU, StateType::TIME), "Menu exit");
+static_assert(StateManager::canTransition(StateType::CONFIG, StateType::TIME), "Config exit");
+
+StateManager::StateManager(Application* application)
+    : app(application), currentState(nullptr), currentType(StateType::TIME), historySize(0) {
 }
 
 StateManager::~StateManager() {
@@ -13,53 +19,90 @@ StateManager::~StateManager() {
 }
 
 void StateManager::registerState(StateType type, std::unique_ptr<State> state) {
-    states[type] = std::move(state);
+    uint8_t index = static_cast<uint8_t>(type);
+    if (index < STATE_COUNT) {
+        states[index] = std::move(state);
+    }
 }
 
 void StateManager::changeState(StateType newState) {
-    auto it = states.find(newState);
-    if (it == states.end()) {
-        Serial.println("Error: State not found!");
+    State* state = target(newState);
+    if (!state) {
         return;
     }
-    
+
     // Exit current state
     if (currentState) {
         Serial.print("Exiting state: ");
         Serial.println(currentState->getName());
         currentState->onExit();
     }
-    
+
     // Clear history on direct state change
-    while (!stateHistory.empty()) {
-        stateHistory.pop();
-    }
-    
-    // Enter new state
-    currentState = it->second.get();
+    historySize = 0;
+
     Serial.print("Entering state: ");
-    Serial.println(currentState->getName());
-    currentState->onEnter();
+    Serial.println(state->getName());
+    enter(newState, state);
 }
 
 void StateManager::pushState(StateType newState) {
+    State* state = target(newState);
+    if (!state) {
+        return;
+    }
+
     if (currentState) {
-        stateHistory.push(getCurrentStateType());
+        if (historySize == HISTORY_DEPTH) {
+            for (uint8_t i = 1; i < HISTORY_DEPTH; i++) {
+                stateHistory[i - 1] = stateHistory[i];
+            }
+            historySize--;
+        }
+        stateHistory[historySize++] = currentType;
         currentState->onExit();
     }
-    
-    auto it = states.find(newState);
-    if (it != states.end()) {
-        currentState = it->second.get();
-        currentState->onEnter();
-    }
+
+    enter(newState, state);
 }
 
 void StateManager::popState() {
-    if (!stateHistory.empty()) {
-        StateType previousState = stateHistory.top();
-        stateHistory.pop();
-        changeState(previousState);
+    if (historySize == 0) {
+        return;
+    }
+
+    // Going back undoes an allowed push, the table is not asked
+    StateType previousState = stateHistory[--historySize];
+    State* state = getState(previousState);
+    if (currentState) {
+        currentState->onExit();
+    }
+    enter(previousState, state);
+}
+
+State* StateManager::target(StateType newState) {
+    State* state = getState(newState);
+    if (!state) {
+        Serial.println("Error: State not found!");
+        return nullptr;
+    }
+
+    // The first state can be any
+    if (currentState && !canTransition(currentType, newState)) {
+        Serial.printf("Error: No transition from %s to %s\n", currentState->getName(), state->getName());
+        return nullptr;
+    }
+    return state;
+}
+
+void StateManager::enter(StateType newState, State* state) {
+    currentState = state;
+    currentType = newState;
+    WarmState::setStateType(static_cast<uint8_t>(newState));
+    currentState->onEnter();
+
+    if (onStateChangeCallback) {
+        onStateChangeCallback(currentState);
     }
 }
 
@@ -86,18 +129,3 @@ void StateManager::handleTimeSync() {
         currentState->onTimeSync();
     }
 }
-
-StateType StateManager::getCurrentStateType() const {
-    if (currentState) {
-        return currentState->getType();
-    }
-    return StateType::TIME; // Default
-}
-
-State* StateManager::getState(StateType type) {
-    auto it = states.find(type);
-    if (it != states.end()) {
-        return it->second.get();
-    }
-    return nullptr;
-}
\ No newline at end of file
@@ -1,44 +1,100 @@
 #ifndef STATE_MANAGER_H
 #define STATE_MANAGER_H
 
+#include <functional>
 #include <memory>
-#include <unordered_map>
-#include <stack>
+#include <stdint.h>
 #include "State.h"
 
 class Application;
 
+// Bit of a state in a set of states
+constexpr uint8_t stateBit(StateType type) {
+    return 1 << static_cast<uint8_t>(type);
+}
+
+// Owns the states and switches between them
+//
+// States sit in an array indexed by StateType and the push history is a
+// fixed array, so looking up or switching a state never hashes or
+// allocates. Which switches are allowed is a constexpr table; changeState()
+// refuses the others, and the switches the code relies on are checked
+// against it at compile time in StateManager.cpp.
 class StateManager {
+public:
+    static constexpr uint8_t STATE_COUNT = static_cast<uint8_t>(StateType::COUNT);
+    static constexpr uint8_t HISTORY_DEPTH = 4;
+
 private:
+    // Targets allowed from each state, one bit per StateType. Re-entering
+    // the current state is always allowed, it redraws the display.
+    static constexpr uint8_t TRANSITIONS[STATE_COUNT] = {
+        // TIME
+        stateBit(StateType::MENU) | stateBit(StateType::TEXT_SCROLL) |
+            stateBit(StateType::AI_CHAT) | stateBit(StateType::CONFIG),
+        // MENU
+        stateBit(StateType::TIME) | stateBit(StateType::TEXT_SCROLL) |
+            stateBit(StateType::AI_CHAT) | stateBit(StateType::CONFIG),
+        // TEXT_SCROLL
+        stateBit(StateType::TIME) | stateBit(StateType::MENU),
+        // AI_CHAT
+        stateBit(StateType::TIME) | stateBit(StateType::MENU),
+        // CONFIG
+        stateBit(StateType::TIME),
+        // NO_TIME
+        stateBit(StateType::TIME) | stateBit(StateType::CONFIG),
+    };
+
     Application* app;
-    std::unordered_map<StateType, std::unique_ptr<State>> states;
+    std::unique_ptr<State> states[STATE_COUNT];
     State* currentState;
-    std::stack<StateType> stateHistory;
-    
+    StateType currentType;
+    StateType stateHistory[HISTORY_DEPTH];
+    uint8_t historySize;
+    std::function<void(State*)> onStateChangeCallback;
+
 public:
     explicit StateManager(Application* application);
     ~StateManager();
-    
+
+    static constexpr bool canTransition(StateType from, StateType to) {
+        return from == to || (TRANSITIONS[static_cast<uint8_t>(from)] & stateBit(to)) != 0;
+    }
+
     // State registration
     void registerState(StateType type, std::unique_ptr<State> state);
-    
+
     // State transitions
     void changeState(StateType newState);
-    void pushState(StateType newState);
+    void pushState(StateType newState);   // Drops the oldest entry when full
     void popState();
-    
+
     // Update current state
     void update();
-    
+
+    // Called after a state was entered, e.g. to follow its update interval
+    void onStateChange(std::function<void(State*)> callback) {
+        onStateChangeCallback = callback;
+    }
+
     // Event forwarding
     void handleButtonEvent(ButtonEvent event);
     void handleNetworkStateChange(bool connected);
     void handleTimeSync();
-    
+
     // Getters
     State* getCurrentState() { return currentState; }
-    StateType getCurrentStateType() const;
-    State* getState(StateType type);
+    StateType getCurrentStateType() const { return currentType; }
+    State* getState(StateType type) {
+        uint8_t index = static_cast<uint8_t>(type);
+        return index < STATE_COUNT ? states[index].get() : nullptr;
+    }
+
+private:
+    // The registered state to switch to, null if it is missing or the
+    // switch is not allowed
+    State* target(StateType newState);
+    void enter(StateType newState, State* state);
 };
 
-#endif // STATE_MANAGER_H
\ No newline at end of file
+#endif // STATE_MANAGER_H
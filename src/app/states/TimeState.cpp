@@ -4,6 +4,9 @@
 #include "app/Application.h"
 #include "services/TimeService.h"
 #include "services/NetworkService.h"
+#include "services/ConfigService.h"
+#include "services/AiService.h"
+#include "services/PowerService.h"
 #include "animator.h"
 #include "menuhandler.h"
 #include <time.h>
@@ -13,7 +16,6 @@ extern std::unique_ptr<MenuHandler> menuHandler;
 
 TimeState::TimeState(Application* application) 
     : State(application), 
-      lastUpdateTime(0), 
       colonVisible(true),
       isAnimating(false),
       lastSecond(-1),
@@ -45,6 +47,9 @@ void TimeState::onEnter() {
     
     isAnimating = false;
     lastSecond = -1;
+    
+    // Show the time right away instead of on the next tick
+    updateTimeDisplay();
 }
 
 void TimeState::onExit() {
@@ -63,19 +68,13 @@ void TimeState::onUpdate() {
         return;  // Don't update display while any animation is active
     }
     
-    unsigned long currentTime = millis();
-    
-    // Update every 500ms for colon blinking
-    if (currentTime - lastUpdateTime >= 500) {
-        lastUpdateTime = currentTime;
-        updateTimeDisplay();
-    }
+    updateTimeDisplay();
 }
 
 void TimeState::updateTimeDisplay() {
     TimeService* timeService = app->getTimeService();
     
-    if (timeService && timeService->isTimeSynced()) {
+    if (timeService && timeService->hasTime()) {
         // Get current time
         time_t now;
         tm timeinfo;
@@ -127,14 +126,17 @@ void TimeState::showDateAnimation() {
     tm* timeCopy = new tm;
     memcpy(timeCopy, &savedTimeInfo, sizeof(tm));
     
+    // Animation speeds from the saved settings
+    ConfigService::Config settings = app->getConfigService()->getConfig();
+    
     // Start fade out animation
-    animator->start_random_fade_out(timeBuffer, 100, [this, timeCopy]() {
+    animator->start_random_fade_out(timeBuffer, settings.fadeOutFrame, [this, timeCopy, settings]() {
         // After fade out, show date
         char dateBuffer[60];
         strftime(dateBuffer, sizeof(dateBuffer), "%A %d %B %Y", timeCopy);
         
         // Set the date text and run scroll animation
-        animator->set_text_and_run(dateBuffer, 210, 1, [this, timeCopy]() {
+        animator->set_text_and_run(dateBuffer, settings.scrollFrame, 1, [this, timeCopy, settings]() {
             // After date scroll, fade back in with current time
             // Get the CURRENT time for the fade-in
             time_t currentNow;
@@ -145,7 +147,7 @@ void TimeState::showDateAnimation() {
             char currentTimeBuffer[10];
             strftime(currentTimeBuffer, sizeof(currentTimeBuffer), "%H%M%S", &currentTimeinfo);
             
-            animator->start_random_fade_in(currentTimeBuffer, 50, [this, timeCopy]() {
+            animator->start_random_fade_in(currentTimeBuffer, settings.fadeInFrame, [this, timeCopy]() {
                 // Animation complete
                 isAnimating = false;
                 delete timeCopy; // Clean up allocated memory
@@ -178,7 +180,7 @@ void TimeState::onButtonEvent(ButtonEvent event) {
         
         // No pending menu action - show date
         TimeService* timeService = app->getTimeService();
-        if (timeService && timeService->isTimeSynced() && !isAnimating) {
+        if (timeService && timeService->hasTime() && !isAnimating) {
             // Get current time
             time_t now;
             tm timeinfo;
@@ -193,7 +195,7 @@ void TimeState::onButtonEvent(ButtonEvent event) {
             animator->stop();
             isAnimating = true;
             
-            animator->set_text_and_run(dateBuffer, 210, 1, [this]() {
+            animator->set_text_and_run(dateBuffer, app->getConfigService()->getConfig().scrollFrame, 1, [this]() {
                 isAnimating = false;
             });
         }
@@ -211,6 +213,28 @@ void TimeState::onButtonEvent(ButtonEvent event) {
         Serial.println("TimeState: Long press released");
         longPressHandled = false;
     }
+    else if (event == ButtonEvent::DOUBLE_PRESS) {
+        // Repeat the last menu selection, e.g. the next record of a file
+        MenuState* menu = static_cast<MenuState*>(app->getStateManager()->getState(StateType::MENU));
+        if (menu->selectItem(menu->getMenuHandler()->getCurrentMenuIndex())) {
+            Serial.println("TimeState: Repeating last menu action");
+            menu->executeSelectedAction();
+        }
+    }
+    else if (event == ButtonEvent::TRIPLE_PRESS) {
+        // Step through the brightness levels of the current mode, kept
+        // like a remote change
+        PowerService* power = app->getPowerService();
+        power->setBrightness((power->getBrightness() + 1) % 8);
+    }
+    else if (event == ButtonEvent::CLICK_HOLD) {
+        // Shortcut to the ai menu item
+        Serial.println("TimeState: Click and hold - asking AI");
+        animator->stop();
+        isAnimating = false;
+        app->getAiService()->ask(AiService::DEFAULT_PROMPT,
+                                 app->getConfigService()->getConfig().scrollFrame);
+    }
 }
 
 void TimeState::onNetworkStateChange(bool connected) {
@@ -11,7 +11,6 @@ class Animator;
 
 class TimeState : public State {
 private:
-    unsigned long lastUpdateTime;
     bool colonVisible;
     std::unique_ptr<Animator> animator;
     bool isAnimating;
@@ -27,6 +26,7 @@ public:
     void onEnter() override;
     void onExit() override;
     void onUpdate() override;
+    unsigned long getUpdateInterval() const override { return 500; } // Colon blink
     void onButtonEvent(ButtonEvent event) override;
     void onNetworkStateChange(bool connected) override;
     void onTimeSync() override;
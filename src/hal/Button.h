@@ -3,37 +3,42 @@
 #define BUTTON_H
 
 #include "IButton.h"
+#include "ButtonGestures.h"
+#include "SpscRing.h"
 #include <Arduino.h>
 
+// Interrupt driven push button, active low
+//
+// The pin interrupt stamps every level change with millis() and queues
+// it in a lock-free ring; update() drains the ring into ButtonGestures,
+// which debounces and classifies the presses by those timestamps. A slow
+// main loop only delays the events. If the ring overflows, the edges are
+// dropped and the gestures restart from the current pin level.
 class Button : public IButton {
 private:
-    uint8_t pin;
-    std::function<void(ButtonEvent)> eventCallback;
+    struct Edge {
+        uint32_t time;
+        bool pressed;
+    };
     
-    // Button state tracking
-    bool currentState;
-    bool lastState;
-    unsigned long lastDebounceTime;
-    unsigned long pressStartTime;
-    bool buttonPressed;
-    bool longPressHandled;
-    bool longPressHoldActive;
+    static constexpr uint8_t EDGE_QUEUE_SIZE = 32;  // Bounces included
     
-    static constexpr unsigned long DEBOUNCE_DELAY = 50;
-    static constexpr unsigned long LONG_PRESS_TIME = 500;
-    static constexpr unsigned long LONG_PRESS_HOLD_INTERVAL = 800;
+    uint8_t pin;
+    std::function<void(ButtonEvent)> eventCallback;
+    ButtonGestures gestures;
+    SpscRing<Edge, EDGE_QUEUE_SIZE> edges;
+    volatile bool edgesLost;
     
 public:
     Button(uint8_t buttonPin);
+    ~Button();
     
     void begin() override;
     void update() override;
     void onButtonEvent(std::function<void(ButtonEvent)> callback) override;
     
 private:
-    void handleButtonPress();
-    void handleButtonRelease();
-    void checkLongPress();
+    static void onEdge(void* arg);
 };
 
-#endif // BUTTON_H
\ No newline at end of file
+#endif // BUTTON_H
@@ -0,0 +1,173 @@
+// hal/ButtonGestures.cpp
+#include "ButtonGestures.h"
+
+// Pairs not listed are ignored, e.g. a release after reset()
+const ButtonGestures::Transition ButtonGestures::TRANSITIONS[] = {
+    // phase          signal                 next            action
+    {Phase::IDLE,    Signal::PRESS,         Phase::DOWN,    Action::NONE},
+    {Phase::DOWN,    Signal::RELEASE,       Phase::UP,      Action::COUNT_CLICK},
+    {Phase::DOWN,    Signal::LONG_TIMEOUT,  Phase::HOLDING, Action::START_HOLD},
+    {Phase::UP,      Signal::PRESS,         Phase::DOWN,    Action::NONE},
+    {Phase::UP,      Signal::CLICK_TIMEOUT, Phase::IDLE,    Action::REPORT_CLICKS},
+    {Phase::HOLDING, Signal::HOLD_TICK,     Phase::HOLDING, Action::REPEAT_HOLD},
+    {Phase::HOLDING, Signal::RELEASE,       Phase::IDLE,    Action::END_HOLD},
+};
+
+ButtonGestures::ButtonGestures(EventCallback callback)
+    : emit(callback),
+      phase(Phase::IDLE),
+      rawPressed(false),
+      rawTime(0),
+      pressed(false),
+      lastTime(0),
+      clicks(0),
+      repeating(false),
+      phaseTime(0),
+      holdInterval(HOLD_INTERVAL),
+      nextHoldTime(0) {
+}
+
+void ButtonGestures::reset(bool isPressed, uint32_t now) {
+    // A gesture in progress is not reported, its start is unknown
+    phase = Phase::IDLE;
+    clicks = 0;
+    rawPressed = isPressed;
+    rawTime = now;
+    pressed = isPressed;
+    lastTime = now;
+}
+
+void ButtonGestures::edge(bool isPressed, uint32_t time) {
+    process(time);
+    if (isPressed != rawPressed) {
+        rawPressed = isPressed;
+        rawTime = time;
+    }
+}
+
+void ButtonGestures::poll(uint32_t now) {
+    process(now);
+}
+
+void ButtonGestures::process(uint32_t now) {
+    if (!reached(now, lastTime)) {
+        now = lastTime;
+    }
+    lastTime = now;
+
+    if (rawPressed != pressed) {
+        // Timers only run up to the edge while it may still be a bounce
+        advance(rawTime);
+        if (!reached(now, rawTime + DEBOUNCE_TIME)) {
+            return;
+        }
+        pressed = rawPressed;
+        signal(pressed ? Signal::PRESS : Signal::RELEASE, rawTime);
+    }
+    advance(now);
+}
+
+// Fire the timeouts of the phases passed through up to `now`
+void ButtonGestures::advance(uint32_t now) {
+    while (true) {
+        Signal timeout;
+        uint32_t deadline;
+        switch (phase) {
+            case Phase::DOWN:
+                timeout = Signal::LONG_TIMEOUT;
+                deadline = phaseTime + LONG_PRESS_TIME;
+                break;
+
+            case Phase::UP:
+                // A press exactly at the end of the window still counts
+                timeout = Signal::CLICK_TIMEOUT;
+                deadline = phaseTime + CLICK_WINDOW + 1;
+                break;
+
+            case Phase::HOLDING:
+                if (!repeating) {
+                    return;
+                }
+                timeout = Signal::HOLD_TICK;
+                deadline = nextHoldTime;
+                break;
+
+            default:
+                return;
+        }
+
+        if (!reached(now, deadline)) {
+            return;
+        }
+        signal(timeout, deadline);
+
+        // Repeats missed during a stall are skipped, not replayed
+        if (phase == Phase::HOLDING) {
+            while (reached(now, nextHoldTime)) {
+                nextHoldTime += holdInterval;
+            }
+        }
+    }
+}
+
+void ButtonGestures::signal(Signal input, uint32_t time) {
+    for (const Transition& transition : TRANSITIONS) {
+        if (transition.phase != phase || transition.signal != input) {
+            continue;
+        }
+        if (transition.next != phase) {
+            phaseTime = time;
+        }
+        phase = transition.next;
+        perform(transition.action, time);
+        return;
+    }
+}
+
+void ButtonGestures::perform(Action action, uint32_t time) {
+    switch (action) {
+        case Action::COUNT_CLICK:
+            // Nothing longer to wait for after the last click
+            if (++clicks == MAX_CLICKS) {
+                phase = Phase::IDLE;
+                clicks = 0;
+                emit(ButtonEvent::TRIPLE_PRESS);
+            }
+            break;
+
+        case Action::REPORT_CLICKS:
+            emit(clicks == 1 ? ButtonEvent::SHORT_PRESS : ButtonEvent::DOUBLE_PRESS);
+            clicks = 0;
+            break;
+
+        case Action::START_HOLD:
+            // Click-then-hold is a gesture of its own and does not repeat
+            repeating = clicks == 0;
+            clicks = 0;
+            if (!repeating) {
+                emit(ButtonEvent::CLICK_HOLD);
+                break;
+            }
+            holdInterval = HOLD_INTERVAL;
+            nextHoldTime = time + holdInterval;
+            emit(ButtonEvent::LONG_PRESS_HOLD);
+            break;
+
+        case Action::REPEAT_HOLD:
+            // Speed up by a quarter per repeat
+            holdInterval = holdInterval * 3 / 4;
+            if (holdInterval < HOLD_INTERVAL_MIN) {
+                holdInterval = HOLD_INTERVAL_MIN;
+            }
+            nextHoldTime = time + holdInterval;
+            emit(ButtonEvent::LONG_PRESS_HOLD);
+            break;
+
+        case Action::END_HOLD:
+            emit(ButtonEvent::LONG_PRESS);
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,113 @@
+// hal/ButtonGestures.h
+#ifndef BUTTON_GESTURES_H
+#define BUTTON_GESTURES_H
+
+#include <functional>
+#include <stdint.h>
+#include "app/states/State.h"
+
+// Debounce and gesture recognition for one button
+//
+// Works on timestamped level changes rather than on the time it is
+// called: edge() takes the raw changes in the order they happened and
+// poll() lets the timers run up to `now`. A stall of the caller therefore
+// delays the events but does not change them.
+//
+// A level counts once it was stable for DEBOUNCE_TIME and is dated to
+// its first edge. The debounced presses, releases and timeouts drive a
+// state machine given as a transition table, see TRANSITIONS. The
+// gestures:
+//
+//   SHORT_PRESS      one click, reported once CLICK_WINDOW passed
+//                    without another press
+//   DOUBLE_PRESS     two clicks
+//   TRIPLE_PRESS     three clicks, reported at the third release
+//   LONG_PRESS_HOLD  held for LONG_PRESS_TIME, then repeated while held;
+//                    the repeats speed up from HOLD_INTERVAL to
+//                    HOLD_INTERVAL_MIN, missed ones are skipped
+//   CLICK_HOLD       a click, then held for LONG_PRESS_TIME; not repeated
+//   LONG_PRESS       release after either hold
+//
+// Plain C++, no Arduino calls, so it can be fed recorded edges on a host.
+class ButtonGestures {
+public:
+    static constexpr uint32_t DEBOUNCE_TIME = 30;
+    static constexpr uint32_t LONG_PRESS_TIME = 500;
+    static constexpr uint32_t CLICK_WINDOW = 250;       // Release to next press
+    static constexpr uint32_t HOLD_INTERVAL = 800;      // First repeat
+    static constexpr uint32_t HOLD_INTERVAL_MIN = 150;  // Fastest repeat
+    static constexpr uint8_t MAX_CLICKS = 3;
+
+    using EventCallback = std::function<void(ButtonEvent)>;
+
+private:
+    enum class Phase : uint8_t {
+        IDLE,
+        DOWN,       // Pressed, not long yet
+        UP,         // Released after a click, more may follow
+        HOLDING     // Pressed past LONG_PRESS_TIME
+    };
+
+    enum class Signal : uint8_t {
+        PRESS,
+        RELEASE,
+        LONG_TIMEOUT,   // DOWN for LONG_PRESS_TIME
+        CLICK_TIMEOUT,  // UP for CLICK_WINDOW
+        HOLD_TICK       // Next hold repeat is due
+    };
+
+    enum class Action : uint8_t {
+        NONE,
+        COUNT_CLICK,
+        REPORT_CLICKS,
+        START_HOLD,
+        REPEAT_HOLD,
+        END_HOLD
+    };
+
+    struct Transition {
+        Phase phase;
+        Signal signal;
+        Phase next;
+        Action action;
+    };
+
+    static const Transition TRANSITIONS[];
+
+    EventCallback emit;
+    Phase phase;
+    bool rawPressed;        // Level of the last edge
+    uint32_t rawTime;       // Time of the last edge
+    bool pressed;           // Debounced level
+    uint32_t lastTime;      // Latest time processed, time never goes back
+
+    // Current gesture
+    uint8_t clicks;
+    bool repeating;         // A plain hold, not CLICK_HOLD
+    uint32_t phaseTime;     // Press or release that started the phase
+    uint32_t holdInterval;
+    uint32_t nextHoldTime;
+
+public:
+    explicit ButtonGestures(EventCallback callback);
+
+    // Start over from a known level, e.g. after edges were lost
+    void reset(bool isPressed, uint32_t now);
+
+    // A raw level change at `time` (ms), bounces included
+    void edge(bool isPressed, uint32_t time);
+
+    // Run the timers up to `now` (ms)
+    void poll(uint32_t now);
+
+    bool isPressed() const { return pressed; }
+
+private:
+    void process(uint32_t now);
+    void advance(uint32_t now);
+    void signal(Signal input, uint32_t time);
+    void perform(Action action, uint32_t time);
+    static bool reached(uint32_t now, uint32_t deadline) { return (int32_t)(now - deadline) >= 0; }
+};
+
+#endif // BUTTON_GESTURES_H
@@ -24,6 +24,9 @@ public:
     virtual void setCharAt(size_t index, char c) = 0;
     virtual void clear() = 0;
     
+    // Raw display RAM, digits then icons; clear() restores the icons
+    virtual void writeFrame(const uint8_t* frame, size_t length) = 0;
+    
     // Icon operations
     virtual void setIcon(DisplayIcon icon, bool enabled) = 0;
     virtual void clearIcons() = 0;
@@ -32,6 +35,9 @@ public:
     virtual void setBrightness(uint8_t level) = 0;
     virtual void setColon(uint8_t colonNumber, bool enabled) = 0;
     
+    // Filament drive (PWM duty 0-255), dims the whole display
+    virtual void setFilament(uint8_t duty) = 0;
+    
     // Power management
     virtual void powerOn() = 0;
     virtual void powerOff() = 0;
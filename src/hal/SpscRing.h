@@ -0,0 +1,53 @@
+// hal/SpscRing.h
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Lock-free ring for one producer and one consumer
+//
+// Meant for handing data from an interrupt to the main loop: the
+// producer only writes `tail` and the consumer only writes `head`, each
+// after its item access, so neither side ever waits for the other.
+// The counters run freely and wrap, SIZE must be a power of two of at
+// most 128.
+template <typename T, uint8_t SIZE>
+class SpscRing {
+    static_assert(SIZE > 0 && SIZE <= 128 && (SIZE & (SIZE - 1)) == 0,
+                  "SpscRing size must be a power of two up to 128");
+
+    T items[SIZE];
+    volatile uint8_t head = 0;  // Next item to pop, consumer side
+    volatile uint8_t tail = 0;  // Next free item, producer side
+
+public:
+    // Producer side, also from an interrupt. False if the ring is full.
+    __attribute__((always_inline)) inline bool push(const T& item) {
+        uint8_t position = tail;
+        if ((uint8_t)(position - head) == SIZE) {
+            return false;
+        }
+        items[position & (SIZE - 1)] = item;
+        std::atomic_signal_fence(std::memory_order_release);
+        tail = position + 1;
+        return true;
+    }
+
+    // Consumer side. False if the ring is empty.
+    bool pop(T& item) {
+        uint8_t position = head;
+        if (position == tail) {
+            return false;
+        }
+        std::atomic_signal_fence(std::memory_order_acquire);
+        item = items[position & (SIZE - 1)];
+        std::atomic_signal_fence(std::memory_order_release);
+        head = position + 1;
+        return true;
+    }
+
+    bool empty() const { return head == tail; }
+};
+
+#endif // SPSC_RING_H
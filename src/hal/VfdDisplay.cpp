@@ -3,7 +3,7 @@
 #include "gui.h" // Your existing GUI functions
 
 VfdDisplay::VfdDisplay() 
-    : brightness(2), activeIcons(0), powered(false) {
+    : brightness(2), filament(FILAMENT_DUTY), activeIcons(0), powered(false), rawFrame(false) {
     colonStates[0] = false;
     colonStates[1] = false;
     Serial.println("VfdDisplay: Constructor called");
@@ -37,6 +37,17 @@ void VfdDisplay::clear() {
     }
     Serial.println("VfdDisplay::clear");
     vfd_gui_clear();
+    if (rawFrame) {
+        rawFrame = false;
+        vfd_gui_draw_pic();
+    }
+}
+
+void VfdDisplay::writeFrame(const uint8_t* frame, size_t length) {
+    if (!powered) return;
+    
+    vfd_gui_write_frame(frame, length);
+    rawFrame = true;
 }
 
 void VfdDisplay::setIcon(DisplayIcon icon, bool enabled) {
@@ -62,6 +73,17 @@ void VfdDisplay::setBrightness(uint8_t level) {
     }
 }
 
+void VfdDisplay::setFilament(uint8_t duty) {
+    if (duty == filament) return;
+    filament = duty;
+    Serial.print("VfdDisplay::setFilament - Duty: ");
+    Serial.println(filament);
+    
+    if (powered) {
+        vfd_gui_set_filament(filament);
+    }
+}
+
 void VfdDisplay::setColon(uint8_t colonNumber, bool enabled) {
     if (!powered || colonNumber > 1) return;
     
@@ -86,8 +108,9 @@ void VfdDisplay::powerOn() {
     
     // Small delay for hardware stabilization
     delay(100);
-    // Set brightness
+    // Set brightness and filament drive
     vfd_gui_set_blk_level(brightness);
+    vfd_gui_set_filament(filament);
     
     // Ensure backlight is on
     vfd_gui_set_bck(1);
@@ -7,9 +7,11 @@
 class VfdDisplay : public IDisplay {
 private:
     uint8_t brightness;
+    uint8_t filament;
     std::bitset<32> activeIcons;
     bool colonStates[2];
     bool powered;
+    bool rawFrame;          // A raw frame covers the icons
     
     // Helper methods
     void updateDisplay();
@@ -23,12 +25,14 @@ public:
     void setText(const std::string& text) override;
     void setCharAt(size_t index, char c) override;
     void clear() override;
+    void writeFrame(const uint8_t* frame, size_t length) override;
     
     void setIcon(DisplayIcon icon, bool enabled) override;
     void clearIcons() override;
     
     void setBrightness(uint8_t level) override;
     void setColon(uint8_t colonNumber, bool enabled) override;
+    void setFilament(uint8_t duty) override;
     
     void powerOn() override;
     void powerOff() override;
@@ -22,8 +22,6 @@ void setup() {
 }
 
 void loop() {
+    // Runs what is due, then sleeps until the next timer or event
     app->update();
-    
-    // Handle any other Arduino-specific tasks
-    yield();
 }
\ No newline at end of file
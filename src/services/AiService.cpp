@@ -0,0 +1,92 @@
+// services/AiService.cpp
+#include "AiService.h"
+#include "NetworkService.h"
+#include "hal/IDisplay.h"
+#include <animator.h>
+
+extern Animator globalAnimator;
+
+AiService::AiService(IDisplay* display, NetworkService* networkService)
+    : display(display),
+      networkService(networkService),
+      started(false) {
+    prompt[0] = '\0';
+    shownReply[0] = '\0';
+}
+
+AiService::~AiService() = default;
+
+void AiService::begin() {
+    cache.begin();
+    started = true;
+
+    const NetworkService::NetworkConfig& config = networkService->getConfig();
+    if (config.api_key[0] == '\0' || config.assistant_id[0] == '\0') {
+        Serial.println("AiService: No API key, cached replies only");
+        return;
+    }
+
+    aiManager = std::make_unique<AiManager>(&globalAnimator, config.api_key, config.assistant_id);
+    aiManager->begin();
+
+    aiManager->onComplete([this](const String& reply) {
+        Serial.printf("AiService: Caching %u bytes for \"%s\"\n", reply.length(), prompt);
+        cache.put(prompt, reply.c_str(), reply.length());
+    });
+
+    aiManager->onError([this](const String& errorMessage) {
+        Serial.print("AiService: No reply for \"");
+        Serial.print(prompt);
+        Serial.print("\": ");
+        Serial.println(errorMessage);
+    });
+}
+
+void AiService::update() {
+    if (aiManager) {
+        aiManager->process();
+    }
+}
+
+void AiService::ask(const char* text, uint8_t scrollFrame) {
+    if (!started) {
+        display->setText("NO AI");
+        return;
+    }
+
+    size_t length = cache.get(text, shownReply, sizeof(shownReply));
+    if (length > 0) {
+        Serial.printf("AiService: Cached reply for \"%s\"\n", text);
+        globalAnimator.stop();
+        display->setIcon(DisplayIcon::PLAY, true);
+        globalAnimator.set_segments_and_run(shownReply, nullptr, scrollFrame);
+
+        // The fresh reply is for the next ask
+        fetch(text, false);
+        return;
+    }
+
+    if (!canFetch()) {
+        display->setText("NO AI");
+        return;
+    }
+    fetch(text, true);
+}
+
+void AiService::prefetch(const char* text) {
+    if (started && !cache.contains(text)) {
+        fetch(text, false);
+    }
+}
+
+bool AiService::canFetch() const {
+    return aiManager && networkService->isConnected() && !aiManager->isActive();
+}
+
+void AiService::fetch(const char* text, bool show) {
+    if (!canFetch()) {
+        return;
+    }
+    strlcpy(prompt, text, sizeof(prompt));
+    aiManager->startConversation(prompt, show);
+}
@@ -0,0 +1,67 @@
+// services/AiService.h
+#ifndef AI_SERVICE_H
+#define AI_SERVICE_H
+
+#include <memory>
+#include <Arduino.h>
+#include <ai_manager.h>
+#include <responsecache.h>
+
+class IDisplay;
+class NetworkService;
+
+// Assistant replies for the "ai" menu item and the "ai" command
+//
+// Replies are kept in a ResponseCache by prompt. A prompt that was
+// answered before shows its cached reply at once while a refresh runs in
+// the background, and the refreshed reply is what the next ask shows.
+// Only a prompt without a cached reply waits for the API, its reply
+// scrolls in as it streams. Offline, or without an API key, the cache is
+// all there is.
+//
+// The application prefetches the default prompt after the asset sync,
+// which needs the pooled TLS connection first, so the first ask is
+// answered from the cache too.
+class AiService {
+public:
+    static constexpr const char* DEFAULT_PROMPT = "hi";
+    static constexpr size_t PROMPT_MAX = 128;
+
+private:
+    IDisplay* display;
+    NetworkService* networkService;
+    std::unique_ptr<AiManager> aiManager; // Only with a configured key
+    ResponseCache cache;
+    bool started;
+
+    // Prompt of the running conversation, its reply goes to the cache
+    char prompt[PROMPT_MAX + 1];
+
+    // Cached reply being scrolled, the animator borrows it
+    char shownReply[AI_REPLY_MAX + 1];
+
+public:
+    AiService(IDisplay* display, NetworkService* networkService);
+    ~AiService();
+
+    // Load the cache and set up the API client from the network settings
+    void begin();
+
+    // Drive a running conversation (call from main loop)
+    void update();
+
+    // Show the reply for `prompt`, from the cache when there is one
+    void ask(const char* prompt, uint8_t scrollFrame);
+
+    // Fetch a reply for `prompt` into the cache without showing it
+    void prefetch(const char* prompt);
+
+    // A request is running
+    bool isBusy() const { return aiManager && aiManager->isActive(); }
+
+private:
+    bool canFetch() const;
+    void fetch(const char* prompt, bool show);
+};
+
+#endif // AI_SERVICE_H
@@ -0,0 +1,145 @@
+// services/AssetSyncService.cpp
+#include "AssetSyncService.h"
+#include "filedownload.h"
+#include "filesink.h"
+#include "menuhandler.h"
+#include "recordstore.h"
+#include "tlspool.h"
+#include <ESP8266WiFi.h>
+
+AssetSyncService::AssetSyncService()
+    : running(false),
+      downloading(false),
+      manifestLoaded(false),
+      failed(false),
+      completedFiles(0),
+      modifiedFiles(0),
+      totalFiles(0) {
+    downloader = std::make_unique<FileDownloader>();
+    downloader->setKeepAlive(true);
+}
+
+AssetSyncService::~AssetSyncService() = default;
+
+void AssetSyncService::begin() {
+    Serial.println("AssetSyncService: Initializing...");
+    downloader->begin();
+}
+
+void AssetSyncService::start() {
+    if (running) {
+        return;
+    }
+    
+    pendingFiles.clear();
+    completedFiles = 0;
+    modifiedFiles = 0;
+    failed = false;
+    manifestLoaded = false;
+    FileSink::resetStats();
+    
+    // The manifest comes first, it names the other files. A complete one
+    // is revalidated with its ETag and costs a 304 if unchanged.
+    pendingFiles.push_back(DATA_FILENAME);
+    totalFiles = 1;
+    
+    Serial.print("AssetSyncService: Syncing ");
+    Serial.print(totalFiles);
+    Serial.println(" file(s)");
+    running = true;
+    
+    if (onProgressCallback) {
+        onProgressCallback(0, totalFiles);
+    }
+}
+
+void AssetSyncService::update() {
+    if (!running) {
+        return;
+    }
+    
+    if (!WiFi.isConnected()) {
+        Serial.println("AssetSyncService: WiFi lost, sync aborted");
+        finish(false);
+        return;
+    }
+    
+    // A bounded slice of the current file per call, so the button, the
+    // display and MQTT keep running while a file comes in
+    FileDownloader::Progress progress;
+    if (!downloading) {
+        currentFile = pendingFiles.front();
+        pendingFiles.erase(pendingFiles.begin());
+        String url = String(ASSET_BASE_URL) + (currentFile.startsWith("/") ? "" : "/") + currentFile;
+        // Ingested files only exist as a record store
+        bool ingested = !LittleFS.exists(currentFile) &&
+                        LittleFS.exists(RecordStore::storeNameFor(currentFile));
+        progress = downloader->start(url.c_str(), currentFile.c_str(), ingested);
+    } else {
+        progress = downloader->step();
+    }
+    downloading = progress == FileDownloader::Progress::RUNNING;
+    if (downloading) {
+        return;
+    }
+    
+    if (progress == FileDownloader::Progress::FAILED) {
+        Serial.print("AssetSyncService: Failed to fetch ");
+        Serial.println(currentFile);
+        failed = true;
+    } else if (downloader->wasModified()) {
+        modifiedFiles++;
+        if (manifestLoaded) {
+            // Record files are kept compressed, ingest while we are at it
+            RecordStore::ingest(currentFile.c_str(), RecordStore::storeNameFor(currentFile).c_str());
+        }
+    }
+    completedFiles++;
+    
+    // A manifest that could not be revalidated is still good if complete
+    if (!manifestLoaded) {
+        queueAssetFiles();
+        failed = failed || !manifestLoaded;
+        totalFiles = completedFiles + pendingFiles.size();
+    }
+    
+    if (onProgressCallback) {
+        onProgressCallback(completedFiles, totalFiles);
+    }
+    
+    if (pendingFiles.empty() || !manifestLoaded) {
+        finish(!failed);
+    }
+}
+
+void AssetSyncService::queueAssetFiles() {
+    std::vector<String> files;
+    if (!MenuHandler::listAssetFiles(files)) {
+        return;
+    }
+    manifestLoaded = true;
+    
+    // Every file is revalidated, a current one costs a 304
+    for (const String& file : files) {
+        pendingFiles.push_back(file);
+    }
+}
+
+void AssetSyncService::finish(bool success) {
+    running = false;
+    downloading = false;
+    pendingFiles.clear();
+    
+    // Release the TLS connection and its buffers, a file cut off here is
+    // resumed by the next sync
+    downloader->end();
+    
+    if (FileSink::stats().bytes > 0) {
+        FileSink::printStats("AssetSyncService");
+    }
+    TlsPool::printStats();
+    
+    if (onCompleteCallback) {
+        onCompleteCallback(success);
+    }
+}
@@ -0,0 +1,61 @@
+// services/AssetSyncService.h
+#ifndef ASSET_SYNC_SERVICE_H
+#define ASSET_SYNC_SERVICE_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <Arduino.h>
+
+class FileDownloader;
+
+// Fetches new or changed menu assets in the background once WiFi is up.
+// Files come one after the other over a single kept-alive connection;
+// each update() call copies at most DOWNLOAD_STEP_SIZE bytes, so the menu
+// never has to wait for the network.
+class AssetSyncService {
+private:
+    std::unique_ptr<FileDownloader> downloader;
+    std::vector<String> pendingFiles;
+    String currentFile;
+    bool running;
+    bool downloading;       // currentFile is between start() and its last step()
+    bool manifestLoaded;
+    bool failed;
+    size_t completedFiles;
+    size_t modifiedFiles;   // Downloaded, not found current
+    size_t totalFiles;
+    
+    std::function<void(size_t done, size_t total)> onProgressCallback;
+    std::function<void(bool success)> onCompleteCallback;
+    
+public:
+    AssetSyncService();
+    ~AssetSyncService();
+    
+    void begin();
+    void update();
+    
+    // Queue the manifest, then every asset it names
+    void start();
+    
+    bool isRunning() const { return running; }
+    
+    // Files the last sync replaced, any of them may have changed the menu
+    size_t changedFiles() const { return modifiedFiles; }
+    
+    // Callbacks
+    void onProgress(std::function<void(size_t done, size_t total)> callback) {
+        onProgressCallback = callback;
+    }
+    
+    void onComplete(std::function<void(bool success)> callback) {
+        onCompleteCallback = callback;
+    }
+    
+private:
+    void queueAssetFiles();
+    void finish(bool success);
+};
+
+#endif // ASSET_SYNC_SERVICE_H
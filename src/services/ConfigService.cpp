@@ -0,0 +1,132 @@
+// services/ConfigService.cpp
+#include "ConfigService.h"
+#include <LittleFS.h>
+#include <coredecls.h>
+
+const char* const ConfigService::SLOT_FILES[2] = {"/config.a", "/config.b"};
+
+ConfigService::ConfigService()
+    : sequence(0),
+      activeSlot(1),
+      dirty(false),
+      lastChangeTime(0) {
+}
+
+void ConfigService::begin() {
+    Serial.println("ConfigService: Loading configuration...");
+
+    if (!LittleFS.begin()) {
+        Serial.println("ConfigService: Failed to mount LittleFS, using defaults");
+        return;
+    }
+
+    // The newest valid slot wins, a torn write only ever hits the other one
+    bool found = false;
+    for (uint8_t slot = 0; slot < 2; slot++) {
+        Config candidate;
+        uint32_t candidateSequence;
+        if (readSlot(slot, candidate, candidateSequence) &&
+            (!found || candidateSequence > sequence)) {
+            config = candidate;
+            sequence = candidateSequence;
+            activeSlot = slot;
+            found = true;
+        }
+    }
+
+    if (found) {
+        Serial.printf("ConfigService: Loaded record #%u from %s\n", sequence, SLOT_FILES[activeSlot]);
+    } else {
+        Serial.println("ConfigService: No saved config, using defaults");
+    }
+}
+
+void ConfigService::update() {
+    if (dirty && millis() - lastChangeTime >= SAVE_DELAY) {
+        save();
+    }
+}
+
+void ConfigService::setConfig(const Config& newConfig) {
+    if (memcmp(&newConfig, &config, sizeof(Config)) == 0) {
+        return;
+    }
+    config = newConfig;
+    dirty = true;
+    lastChangeTime = millis();
+}
+
+void ConfigService::save() {
+    if (!dirty) {
+        return;
+    }
+
+    uint8_t slot = activeSlot ^ 1;
+    RecordHeader header = {{'V', 'C', 'F', 'G'}, CONFIG_VERSION, sizeof(Config), sequence + 1, 0};
+    header.crc = recordCrc(header, (const uint8_t*)&config);
+
+    File file = LittleFS.open(SLOT_FILES[slot], "w");
+    if (!file) {
+        Serial.printf("ConfigService: Failed to open %s\n", SLOT_FILES[slot]);
+        return;
+    }
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t*)&config, sizeof(Config)) == sizeof(Config);
+    file.close();
+
+    if (!ok) {
+        // The active slot is untouched, retry after the next delay
+        Serial.println("ConfigService: Save failed");
+        lastChangeTime = millis();
+        return;
+    }
+
+    sequence = header.sequence;
+    activeSlot = slot;
+    dirty = false;
+    Serial.printf("ConfigService: Saved record #%u to %s\n", sequence, SLOT_FILES[slot]);
+}
+
+bool ConfigService::readSlot(uint8_t slot, Config& out, uint32_t& outSequence) {
+    if (!LittleFS.exists(SLOT_FILES[slot])) {
+        return false;
+    }
+    File file = LittleFS.open(SLOT_FILES[slot], "r");
+    if (!file) {
+        return false;
+    }
+
+    RecordHeader header;
+    uint8_t payload[MAX_RECORD_SIZE];
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+              memcmp(header.magic, "VCFG", 4) == 0 &&
+              header.size <= MAX_RECORD_SIZE &&
+              file.read(payload, header.size) == header.size &&
+              recordCrc(header, payload) == header.crc;
+    file.close();
+
+    if (!ok) {
+        Serial.printf("ConfigService: Ignoring invalid record in %s\n", SLOT_FILES[slot]);
+        return false;
+    }
+
+    // Fields the record does not have keep their defaults
+    out = Config();
+    memcpy(&out, payload, min((size_t)header.size, sizeof(Config)));
+    outSequence = header.sequence;
+    return true;
+}
+
+uint32_t ConfigService::recordCrc(const RecordHeader& header, const uint8_t* payload) {
+    uint32_t crc = crc32(&header.version, sizeof(header.version) + sizeof(header.size) + sizeof(header.sequence));
+    return crc32(payload, header.size, crc);
+}
+
+bool ConfigService::isSettingsFile(const String& path) {
+    for (const char* slotFile : SLOT_FILES) {
+        if (path == slotFile || path == slotFile + 1) {
+            return true;
+        }
+    }
+    return false;
+}
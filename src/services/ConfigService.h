@@ -2,27 +2,78 @@
 #ifndef CONFIG_SERVICE_H
 #define CONFIG_SERVICE_H
 
+#include <Arduino.h>
+
+// Persistent device settings
+//
+// The settings are stored as a binary record in two LittleFS files used
+// alternately (A/B). Each save goes to the slot that does not hold the
+// current record and carries a higher sequence number, so an interrupted
+// write leaves the previous record intact. Records are CRC protected and
+// read straight into Config at boot, without any parsing.
+//
+// Saves are deferred: changes are collected and written from update()
+// once the settings have been stable for SAVE_DELAY, one small file
+// write per save.
 class ConfigService {
 public:
+    // Binary layout, fields may only be appended. Records written by an
+    // older version are shorter, missing fields keep their defaults.
     struct Config {
-        // Add your config fields here
-        //uint8_t brightness = 2;
-        // ... other config
+        uint8_t brightness = 2;     // Display dimming level
+        uint8_t scrollFrame = 210;  // Text scroll step (ms)
+        uint8_t fadeInFrame = 50;   // Time fade-in step (ms)
+        uint8_t fadeOutFrame = 100; // Time fade-out step (ms)
+        uint8_t nightStart = 23;    // Hour the night dimming starts
+        uint8_t nightEnd = 7;       // Hour it ends, equal to nightStart for none
+        uint8_t nightBrightness = 0; // Dimming level at night
     };
-    
-    ConfigService() {}
-    
-    void begin() {
-        // Load config from EEPROM in the future
-    }
-    
-    void save() {
-        // Save config to EEPROM in the future
-    }
-    
-    const Config& getConfig() const { return config; }
-    
+
+    static constexpr uint16_t CONFIG_VERSION = 1;
+
 private:
+    struct RecordHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t size;
+        uint32_t sequence;
+        uint32_t crc;       // Over sequence, version, size and payload
+    };
+
     Config config;
+    uint32_t sequence;
+    uint8_t activeSlot;
+    bool dirty;
+    unsigned long lastChangeTime;
+    static constexpr unsigned long SAVE_DELAY = 2000; // 2 seconds
+    static constexpr uint16_t MAX_RECORD_SIZE = 128;  // Payload limit, also for newer versions
+    static const char* const SLOT_FILES[2];
+    static_assert(sizeof(Config) <= MAX_RECORD_SIZE, "Config outgrew the record size limit");
+
+public:
+    ConfigService();
+
+    // Load the newest valid record
+    void begin();
+
+    // Write pending changes once they have settled (call from main loop)
+    void update();
+
+    const Config& getConfig() const { return config; }
+
+    // Replace the settings, saved later by update()
+    void setConfig(const Config& newConfig);
+
+    // Write pending changes now
+    void save();
+
+    // Whether `path` is one of the settings files, with or without the
+    // leading slash that directory listings leave out
+    static bool isSettingsFile(const String& path);
+
+private:
+    bool readSlot(uint8_t slot, Config& out, uint32_t& outSequence);
+    static uint32_t recordCrc(const RecordHeader& header, const uint8_t* payload);
 };
-#endif // CONFIG_SERVICE_H
\ No newline at end of file
+
+#endif // CONFIG_SERVICE_H
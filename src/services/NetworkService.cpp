@@ -10,7 +10,13 @@ static String generatedPassword;
 NetworkService::NetworkService() 
     : connected(false), 
       configMode(false),
-      lastConnectionCheck(0) {
+      linkState(LinkState::IDLE),
+      stateSince(0),
+      backoffDelay(BACKOFF_MIN),
+      failedAttempts(0),
+      everConnected(false),
+      gotIpEvent(false),
+      disconnectedEvent(false) {
     networkServiceInstance = this;
 }
 
@@ -42,63 +48,152 @@ void NetworkService::begin() {
     // Set AP callback
     wifiManager->setAPCallback(NetworkService::configModeCallback);
     
-    // Try to connect with saved credentials
-    // Generate a unique password for AP mode
-    generatedPassword = String(random(10000000, 99999999));
-    generatedPassword.toUpperCase();
-    
-    Serial.println("NetworkService: Attempting to connect to WiFi...");
+    // The portal is served from update() instead of blocking here
+    wifiManager->setConfigPortalBlocking(false);
+    wifiManager->setConfigPortalTimeout(CONFIG_PORTAL_TIMEOUT);
     
-    // Set shorter timeout for faster startup
-    wifiManager->setConfigPortalTimeout(180); // 3 minutes
+    // Reconnects are ours, with backoff
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
     
-    // Try to connect
-    bool success = wifiManager->autoConnect("VFD-03", generatedPassword.c_str());
-    
-    if (success) {
-        connected = true;
-        Serial.print("NetworkService: Connected to WiFi! IP: ");
-        Serial.println(WiFi.localIP());
-        
-        // Notify callback
-        if (onConnectionChangeCallback) {
-            onConnectionChangeCallback(true);
+    // Only flags are set here, the SDK calls these from its own context
+    gotIpHandler = WiFi.onStationModeGotIP([this](const WiFiEventStationModeGotIP&) {
+        gotIpEvent = true;
+        if (onLinkEventCallback) {
+            onLinkEventCallback();
+        }
+    });
+    disconnectedHandler = WiFi.onStationModeDisconnected([this](const WiFiEventStationModeDisconnected&) {
+        disconnectedEvent = true;
+        if (onLinkEventCallback) {
+            onLinkEventCallback();
         }
+    });
+    
+    if (WiFi.SSID().isEmpty()) {
+        Serial.println("NetworkService: No saved network");
+        startConfigPortal();
     } else {
-        Serial.println("NetworkService: Failed to connect to WiFi");
-        connected = false;
+        Serial.println("NetworkService: Attempting to connect to WiFi...");
+        connect();
     }
-    
-    configMode = false;
 }
 
 void NetworkService::update() {
-    unsigned long currentTime = millis();
-    
-    // Periodically check connection status
-    if (currentTime - lastConnectionCheck >= CONNECTION_CHECK_INTERVAL) {
-        lastConnectionCheck = currentTime;
-        
-        bool currentState = WiFi.isConnected();
-        if (currentState != connected) {
-            connected = currentState;
-            
-            Serial.print("NetworkService: Connection state changed to ");
-            Serial.println(connected ? "connected" : "disconnected");
-            
-            // If disconnected, try to reconnect
-            if (!connected && !configMode) {
-                Serial.println("NetworkService: Attempting to reconnect...");
-                WiFi.reconnect();
+    if (!wifiManager) {
+        return; // Not started yet
+    }
+    
+    if (linkState == LinkState::PORTAL) {
+        wifiManager->process();
+        if (!wifiManager->getConfigPortalActive()) {
+            // Closed after new credentials connected, or timed out
+            Serial.println("NetworkService: Config portal closed");
+            configMode = false;
+            if (WiFi.isConnected()) {
+                gotIpEvent = true;
+            } else {
+                // Counts as a failed attempt, so the backoff grows
+                failedAttempts++;
+                scheduleReconnect();
+            }
+        }
+    }
+    
+    // Link events
+    if (gotIpEvent) {
+        gotIpEvent = false;
+        if (wifiManager->getConfigPortalActive()) {
+            wifiManager->stopConfigPortal();
+            configMode = false;
+        }
+        failedAttempts = 0;
+        backoffDelay = BACKOFF_MIN;
+        everConnected = true;
+        setLinkState(LinkState::CONNECTED);
+        setConnected(true);
+    }
+    
+    if (disconnectedEvent) {
+        disconnectedEvent = false;
+        // While connecting the SDK reports every failed try, the timeout
+        // below handles those
+        if (linkState == LinkState::CONNECTED) {
+            setConnected(false);
+            scheduleReconnect();
+        }
+    }
+    
+    unsigned long elapsed = millis() - stateSince;
+    switch (linkState) {
+        case LinkState::CONNECTING:
+            if (elapsed >= CONNECT_TIMEOUT) {
+                failedAttempts++;
+                Serial.println("NetworkService: Connection attempt timed out");
+                
+                // Like autoConnect: a network that never came up at boot
+                // may need new credentials
+                if (!everConnected && failedAttempts == 1) {
+                    startConfigPortal();
+                } else {
+                    scheduleReconnect();
+                }
             }
+            break;
             
-            if (onConnectionChangeCallback) {
-                onConnectionChangeCallback(connected);
+        case LinkState::BACKOFF:
+            if (elapsed >= backoffDelay) {
+                // Nothing to connect to until someone enters credentials
+                if (WiFi.SSID().isEmpty()) {
+                    startConfigPortal();
+                } else {
+                    connect();
+                }
             }
-        }
+            break;
+            
+        default:
+            break;
     }
 }
 
+void NetworkService::connect() {
+    setLinkState(LinkState::CONNECTING);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin();
+}
+
+void NetworkService::scheduleReconnect() {
+    backoffDelay = min(BACKOFF_MIN << min(failedAttempts, (uint8_t)8), BACKOFF_MAX);
+    Serial.print("NetworkService: Reconnecting in ");
+    Serial.print(backoffDelay / 1000);
+    Serial.println(" s");
+    setLinkState(LinkState::BACKOFF);
+}
+
+void NetworkService::setConnected(bool state) {
+    if (state == connected) {
+        return;
+    }
+    connected = state;
+    
+    Serial.print("NetworkService: Connection state changed to ");
+    Serial.println(connected ? "connected" : "disconnected");
+    if (connected) {
+        Serial.print("NetworkService: IP: ");
+        Serial.println(WiFi.localIP());
+    }
+    
+    if (onConnectionChangeCallback) {
+        onConnectionChangeCallback(connected);
+    }
+}
+
+void NetworkService::setLinkState(LinkState state) {
+    linkState = state;
+    stateSince = millis();
+}
+
 void NetworkService::startConfigPortal() {
     Serial.println("NetworkService: Starting config portal...");
     configMode = true;
@@ -107,16 +202,9 @@ void NetworkService::startConfigPortal() {
     generatedPassword = String(random(10000000, 99999999));
     generatedPassword.toUpperCase();
     
-    // Start config portal
+    // Returns right away in non-blocking mode, update() serves it
+    setLinkState(LinkState::PORTAL);
     wifiManager->startConfigPortal("VFD-03", generatedPassword.c_str());
-    
-    configMode = false;
-    
-    // Check if we're now connected
-    connected = WiFi.isConnected();
-    if (onConnectionChangeCallback) {
-        onConnectionChangeCallback(connected);
-    }
 }
 
 void NetworkService::resetSettings() {
@@ -7,8 +7,24 @@
 #include <ESP8266WiFi.h>
 #include <WiFiManager.h>
 
+// WiFi connection as a non-blocking state machine
+//
+// Connection attempts, the config portal and reconnects all progress from
+// update(); link changes arrive through the WiFi event callbacks and are
+// handled there too. When the saved network cannot be reached at boot
+// the config portal opens, as with WiFiManager's autoConnect. A dropped
+// link is retried with exponential backoff. Without saved credentials
+// the portal reopens after each backoff until it gets some.
 class NetworkService {
 public:
+    enum class LinkState {
+        IDLE,
+        CONNECTING,
+        CONNECTED,
+        BACKOFF,    // Waiting before the next attempt
+        PORTAL      // Config portal open
+    };
+    
     struct NetworkConfig {
         char mqtt_server[40];
         char mqtt_port[6];
@@ -19,8 +35,14 @@ public:
 private:
     bool connected;
     bool configMode;
+    LinkState linkState;
+    unsigned long stateSince;
+    unsigned long backoffDelay;
+    uint8_t failedAttempts;
+    bool everConnected;
     std::function<void(bool)> onConnectionChangeCallback;
     std::function<void(const NetworkConfig&)> onConfigSaveCallback;
+    std::function<void()> onLinkEventCallback;
     
     std::unique_ptr<WiFiManager> wifiManager;
     NetworkConfig config;
@@ -31,9 +53,17 @@ private:
     std::unique_ptr<WiFiManagerParameter> custom_apikey;
     std::unique_ptr<WiFiManagerParameter> custom_assistantid;
     
+    // WiFi events, set from the SDK callbacks and handled in update()
+    WiFiEventHandler gotIpHandler;
+    WiFiEventHandler disconnectedHandler;
+    volatile bool gotIpEvent;
+    volatile bool disconnectedEvent;
+    
     // Connection management
-    unsigned long lastConnectionCheck;
-    static constexpr unsigned long CONNECTION_CHECK_INTERVAL = 5000; // Check every 5 seconds
+    static constexpr unsigned long CONNECT_TIMEOUT = 15000;   // 15 seconds
+    static constexpr unsigned long BACKOFF_MIN = 1000;        // 1 second
+    static constexpr unsigned long BACKOFF_MAX = 300000;      // 5 minutes
+    static constexpr unsigned long CONFIG_PORTAL_TIMEOUT = 180; // 3 minutes, in seconds
     
 public:
     NetworkService();
@@ -44,9 +74,13 @@ public:
     
     bool isConnected() const { return connected; }
     bool isInConfigMode() const { return configMode; }
+    LinkState getLinkState() const { return linkState; }
+    
+    // A connection attempt is in progress
+    bool isConnecting() const { return linkState == LinkState::CONNECTING; }
     const NetworkConfig& getConfig() const { return config; }
     
-    // Force configuration portal
+    // Open the configuration portal, it runs from update()
     void startConfigPortal();
     
     // Reset WiFi settings
@@ -61,7 +95,16 @@ public:
         onConfigSaveCallback = callback;
     }
     
+    // Called from the SDK context when a link event waits for update()
+    void onLinkEvent(std::function<void()> callback) {
+        onLinkEventCallback = callback;
+    }
+    
 private:
+    void connect();
+    void scheduleReconnect();
+    void setConnected(bool state);
+    void setLinkState(LinkState state);
     void loadConfig();
     void saveConfig();
     void setupWiFiManager();
@@ -0,0 +1,125 @@
+// services/PowerService.cpp
+#include "PowerService.h"
+#include "ConfigService.h"
+#include "TimeService.h"
+#include "hal/IDisplay.h"
+#include <ESP8266WiFi.h>
+#include <user_interface.h>
+
+// Rough draw of the board in mW, from datasheet figures rather than a
+// measurement; good for comparing modes, not for billing
+static constexpr uint32_t SOC_MODEM_SLEEP_MW = 50;  // 80 MHz, radio off between beacons
+static constexpr uint32_t SOC_AWAKE_MW = 230;       // Radio always receiving
+static constexpr uint32_t SOC_TURBO_MW = 30;        // Extra at 160 MHz
+static constexpr uint32_t FILAMENT_FULL_MW = 1200;  // At PWM duty 255
+static constexpr uint32_t DISPLAY_BASE_MW = 80;     // Driver and HV supply
+static constexpr uint32_t DISPLAY_LEVEL_MW = 25;    // Per dimming level
+
+PowerService::PowerService(IDisplay* display, ConfigService* configService, TimeService* timeService)
+    : display(display),
+      configService(configService),
+      timeService(timeService),
+      night(false),
+      busy(false),
+      appliedBrightness(0xFF),
+      milliwatts(0),
+      energy(0),
+      lastSample(millis()) {
+}
+
+void PowerService::begin() {
+    Serial.println("PowerService: Initializing...");
+    
+    // Booting counts as busy, see Application, so this stays at full speed
+    // until the boot stages are done
+    night = nightHour();
+    busy = busyCheck && busyCheck();
+    applySchedule();
+    applyPerformance();
+    milliwatts = estimate();
+    lastSample = millis();
+}
+
+void PowerService::update() {
+    // The time since the last update counts at the draw of its mode
+    sample();
+
+    bool wasNight = night;
+    bool wasBusy = busy;
+    night = nightHour();
+    busy = busyCheck && busyCheck();
+
+    const ConfigService::Config& config = configService->getConfig();
+    uint8_t level = night ? config.nightBrightness : config.brightness;
+    if (night != wasNight || level != appliedBrightness) {
+        // Only on changes, so a brightness set by hand lasts until the
+        // next switch
+        applySchedule();
+    }
+    if (night != wasNight || busy != wasBusy) {
+        applyPerformance();
+    }
+    milliwatts = estimate();
+}
+
+uint8_t PowerService::getBrightness() const {
+    const ConfigService::Config& config = configService->getConfig();
+    return night ? config.nightBrightness : config.brightness;
+}
+
+void PowerService::setBrightness(uint8_t level) {
+    ConfigService::Config config = configService->getConfig();
+    (night ? config.nightBrightness : config.brightness) = level;
+    configService->setConfig(config);
+    
+    appliedBrightness = level;
+    display->setBrightness(level);
+    milliwatts = estimate();
+    Serial.printf("PowerService: %s brightness %u\n", night ? "Night" : "Day", level);
+}
+
+bool PowerService::nightHour() const {
+    if (!timeService->hasTime()) {
+        return false;
+    }
+
+    const ConfigService::Config& config = configService->getConfig();
+    int hour = timeService->getCurrentTime().hour;
+    if (config.nightStart <= config.nightEnd) {
+        return hour >= config.nightStart && hour < config.nightEnd;
+    }
+    // Across midnight
+    return hour >= config.nightStart || hour < config.nightEnd;
+}
+
+void PowerService::applySchedule() {
+    const ConfigService::Config& config = configService->getConfig();
+    appliedBrightness = night ? config.nightBrightness : config.brightness;
+    Serial.printf("PowerService: %s mode, brightness %u\n", night ? "Night" : "Day", appliedBrightness);
+
+    display->setBrightness(appliedBrightness);
+    display->setFilament(night ? FILAMENT_NIGHT : FILAMENT_DAY);
+}
+
+void PowerService::applyPerformance() {
+    system_update_cpu_freq(busy ? SYS_CPU_160MHZ : SYS_CPU_80MHZ);
+
+    if (busy) {
+        WiFi.setSleepMode(WIFI_NONE_SLEEP);
+    } else {
+        WiFi.setSleepMode(WIFI_MODEM_SLEEP, night ? NIGHT_LISTEN_INTERVAL : 0);
+    }
+}
+
+void PowerService::sample() {
+    unsigned long now = millis();
+    energy += (uint64_t)milliwatts * (now - lastSample);
+    lastSample = now;
+}
+
+uint32_t PowerService::estimate() const {
+    uint32_t draw = busy ? SOC_AWAKE_MW + SOC_TURBO_MW : SOC_MODEM_SLEEP_MW;
+    draw += FILAMENT_FULL_MW * (night ? FILAMENT_NIGHT : FILAMENT_DAY) / 255;
+    draw += DISPLAY_BASE_MW + DISPLAY_LEVEL_MW * appliedBrightness;
+    return draw;
+}
@@ -0,0 +1,80 @@
+// services/PowerService.h
+#ifndef POWER_SERVICE_H
+#define POWER_SERVICE_H
+
+#include <functional>
+#include <Arduino.h>
+
+class IDisplay;
+class ConfigService;
+class TimeService;
+
+// Cuts the draw of an idle clock
+//
+// Between the night hours of the settings the display drops to the night
+// dimming level and the filament is driven at FILAMENT_NIGHT instead of
+// FILAMENT_DAY. Without a known time it stays in day mode.
+//
+// The CPU runs at 80 MHz and WiFi in modem sleep, which keeps the
+// association but powers the radio down between beacons. While the busy
+// check reports work that wants speed or latency (TLS, a remote frame
+// stream), the CPU goes to 160 MHz and WiFi stays awake. At night WiFi
+// only listens every NIGHT_LISTEN_INTERVAL beacons, still well within the
+// MQTT keepalive.
+//
+// The draw of each mode is estimated from a rough model of the board and
+// integrated into an energy counter, published over MQTT.
+class PowerService {
+public:
+    static constexpr uint8_t FILAMENT_DAY = 25;     // PWM duty, as after power on
+    static constexpr uint8_t FILAMENT_NIGHT = 15;
+    static constexpr uint8_t NIGHT_LISTEN_INTERVAL = 3;
+
+private:
+    IDisplay* display;
+    ConfigService* configService;
+    TimeService* timeService;
+    std::function<bool()> busyCheck;
+
+    bool night;
+    bool busy;
+    uint8_t appliedBrightness;      // Level set by the schedule, 0xFF for none yet
+
+    // Estimate
+    uint32_t milliwatts;
+    uint64_t energy;                // mW ms since boot
+    unsigned long lastSample;
+
+public:
+    PowerService(IDisplay* display, ConfigService* configService, TimeService* timeService);
+
+    // Apply the mode for the current hour and busy check; set the busy
+    // check first
+    void begin();
+
+    // Follow the schedule and the busy check (call every second or so)
+    void update();
+
+    // True while the CPU should run fast and WiFi stay awake
+    void setBusyCheck(std::function<bool()> check) { busyCheck = check; }
+
+    bool isNight() const { return night; }
+    
+    // Dimming level of the current mode, and setting it: shown now and
+    // stored as the night or the day level of the settings
+    uint8_t getBrightness() const;
+    void setBrightness(uint8_t level);
+
+    // Estimated draw now and energy used since boot
+    uint32_t estimatedMilliwatts() const { return milliwatts; }
+    uint32_t energyMilliwattHours() const { return energy / 3600000; }
+
+private:
+    bool nightHour() const;
+    void applySchedule();
+    void applyPerformance();
+    void sample();
+    uint32_t estimate() const;
+};
+
+#endif // POWER_SERVICE_H
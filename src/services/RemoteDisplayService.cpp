@@ -0,0 +1,244 @@
+// services/RemoteDisplayService.cpp
+#include "RemoteDisplayService.h"
+#include "hal/IDisplay.h"
+#include <animator.h>
+#include <gui.h>
+
+extern Animator globalAnimator;
+
+RemoteDisplayService::RemoteDisplayService(IDisplay* display)
+    : display(display),
+      listening(false),
+      slotCount(0),
+      active(false),
+      buffering(false),
+      lastSequence(0),
+      bufferStart(0),
+      lastPlayTime(0),
+      lastPacketTime(0),
+      playedPackets(0),
+      stalePackets(0),
+      overflowPackets(0),
+      underruns(0) {
+}
+
+void RemoteDisplayService::begin() {
+    listening = udp.begin(UDP_PORT);
+    Serial.printf("RemoteDisplayService: %s on UDP port %u\n",
+                  listening ? "Listening" : "Failed to listen", UDP_PORT);
+}
+
+void RemoteDisplayService::update() {
+    if (listening) {
+        // Datagrams larger than any valid packet are dropped unread
+        int size;
+        while ((size = udp.parsePacket()) > 0) {
+            uint8_t packet[HEADER_SIZE + PAYLOAD_MAX];
+            if ((size_t)size <= sizeof(packet)) {
+                receive(packet, udp.read(packet, sizeof(packet)));
+            }
+            udp.flush();
+        }
+    }
+
+    if (!active) {
+        return;
+    }
+
+    // A text effect plays to its end before the next packet
+    if (globalAnimator.is_running()) {
+        return;
+    }
+
+    unsigned long now = millis();
+    if (now - lastPacketTime >= IDLE_TIMEOUT) {
+        endStream();
+        return;
+    }
+
+    if (buffering) {
+        if (slotCount == 0 || (slotCount < PREBUFFER && now - bufferStart < PREBUFFER * FRAME_INTERVAL)) {
+            return;
+        }
+        buffering = false;
+        lastPlayTime = now - FRAME_INTERVAL;
+    }
+
+    if (now - lastPlayTime < FRAME_INTERVAL) {
+        return;
+    }
+
+    if (slotCount == 0) {
+        // Hold the last frame and collect a new prebuffer
+        underruns++;
+        buffering = true;
+        return;
+    }
+
+    // Keep the pace, but do not catch up in a burst after a stall
+    lastPlayTime += FRAME_INTERVAL;
+    if (now - lastPlayTime >= FRAME_INTERVAL) {
+        lastPlayTime = now;
+    }
+
+    Slot slot = slots[0];
+    slotCount--;
+    memmove(&slots[0], &slots[1], slotCount * sizeof(Slot));
+    lastSequence = slot.sequence;
+    play(slot);
+}
+
+bool RemoteDisplayService::receive(const uint8_t* packet, size_t length) {
+    if (length < HEADER_SIZE || packet[0] != 'V' || packet[1] != 'F' || packet[2] != PROTOCOL_VERSION) {
+        return false;
+    }
+
+    PacketType type = static_cast<PacketType>(packet[3]);
+    uint16_t sequence = (packet[4] << 8) | packet[5];
+    const uint8_t* payload = packet + HEADER_SIZE;
+    size_t payloadLength = length - HEADER_SIZE;
+
+    bool valid;
+    switch (type) {
+        case PacketType::FRAME:
+            valid = payloadLength == VFD_FRAME_LEN;
+            break;
+        case PacketType::TEXT:
+            valid = payloadLength >= 1 && payloadLength <= PAYLOAD_MAX &&
+                    payload[0] < static_cast<uint8_t>(Effect::COUNT);
+            break;
+        case PacketType::END:
+            valid = payloadLength == 0;
+            break;
+        default:
+            valid = false;
+            break;
+    }
+    if (!valid) {
+        Serial.println("RemoteDisplayService: Invalid packet");
+        return false;
+    }
+
+    if (!active) {
+        startStream(sequence);
+    }
+    lastPacketTime = millis();
+
+    if (!isNewer(sequence, lastSequence)) {
+        stalePackets++;
+        return false;
+    }
+
+    // Insertion point, the buffer stays ordered by sequence number
+    uint8_t position = slotCount;
+    while (position > 0 && isNewer(slots[position - 1].sequence, sequence)) {
+        position--;
+    }
+    if (position > 0 && slots[position - 1].sequence == sequence) {
+        stalePackets++;
+        return false;
+    }
+
+    if (slotCount == JITTER_SLOTS) {
+        // Full: skip the oldest packet, unless the new one is older still
+        if (position == 0) {
+            overflowPackets++;
+            return false;
+        }
+        lastSequence = slots[0].sequence;
+        slotCount--;
+        position--;
+        memmove(&slots[0], &slots[1], slotCount * sizeof(Slot));
+        overflowPackets++;
+    }
+
+    memmove(&slots[position + 1], &slots[position], (slotCount - position) * sizeof(Slot));
+    Slot& slot = slots[position];
+    slot.sequence = sequence;
+    slot.type = type;
+    slot.length = payloadLength;
+    memcpy(slot.payload, payload, payloadLength);
+    if (slotCount == 0 && buffering) {
+        bufferStart = millis();
+    }
+    slotCount++;
+    return true;
+}
+
+void RemoteDisplayService::startStream(uint16_t sequence) {
+    Serial.println("RemoteDisplayService: Stream started");
+    active = true;
+    buffering = true;
+    slotCount = 0;
+    lastSequence = sequence - 1;
+    playedPackets = 0;
+    stalePackets = 0;
+    overflowPackets = 0;
+    underruns = 0;
+
+    globalAnimator.stop();
+    if (onActiveChangeCallback) {
+        onActiveChangeCallback(true);
+    }
+}
+
+void RemoteDisplayService::endStream() {
+    Serial.printf("RemoteDisplayService: Stream ended, %u played, %u stale, %u overflowed, %u underruns\n",
+                  playedPackets, stalePackets, overflowPackets, underruns);
+    active = false;
+    slotCount = 0;
+
+    globalAnimator.stop();
+    display->clear();
+    if (onActiveChangeCallback) {
+        onActiveChangeCallback(false);
+    }
+}
+
+void RemoteDisplayService::play(const Slot& slot) {
+    playedPackets++;
+
+    if (slot.type == PacketType::FRAME) {
+        display->writeFrame(slot.payload, slot.length);
+        return;
+    }
+    if (slot.type == PacketType::END) {
+        endStream();
+        return;
+    }
+
+    // The animator borrows the scrolled text, so it lives here
+    static char text[TEXT_MAX + 1];
+    size_t textLength = slot.length - 1;
+    memcpy(text, slot.payload + 1, textLength);
+    text[textLength] = '\0';
+
+    switch (static_cast<Effect>(slot.payload[0])) {
+        case Effect::STATIC:
+            display->setText(text);
+            break;
+        case Effect::SCROLL:
+            globalAnimator.set_segments_and_run(text, nullptr);
+            break;
+        case Effect::FADE:
+            globalAnimator.start_fade_in(text);
+            break;
+        case Effect::WAVE:
+            globalAnimator.start_wave_effect(text);
+            break;
+        case Effect::TYPEWRITER:
+            globalAnimator.start_typewriter_effect(text);
+            break;
+        case Effect::REVEAL:
+            globalAnimator.start_reveal_effect(text);
+            break;
+        case Effect::COUNT:
+            break;
+    }
+}
+
+// Serial number arithmetic, valid while the two are less than half the
+// sequence space apart
+bool RemoteDisplayService::isNewer(uint16_t sequence, uint16_t than) {
+    return static_cast<int16_t>(sequence - than) > 0;
+}
@@ -0,0 +1,117 @@
+// services/RemoteDisplayService.h
+#ifndef REMOTE_DISPLAY_SERVICE_H
+#define REMOTE_DISPLAY_SERVICE_H
+
+#include <functional>
+#include <Arduino.h>
+#include <WiFiUdp.h>
+
+class IDisplay;
+
+// Remote framebuffer
+//
+// A host drives the display with packets sent to UDP_PORT, or published
+// to the MQTT command topic "frame". Packet layout, integers big endian:
+//
+//   0  2   Magic "VF"
+//   2  1   PROTOCOL_VERSION
+//   3  1   PacketType
+//   4  2   Sequence number, wraps around
+//   6  ..  FRAME: VFD_FRAME_LEN bytes of display RAM (digits, then icons)
+//          TEXT:  Effect (1 byte), then up to TEXT_MAX characters
+//          END:   nothing
+//
+// Packets that are not newer than the last one played are dropped, so a
+// late datagram never moves the display backwards. The others wait in a
+// small jitter buffer ordered by sequence number and are played one per
+// FRAME_INTERVAL, after PREBUFFER packets were collected. A text with an
+// effect holds playback until its animation ended. The stream is over
+// after an END packet or IDLE_TIMEOUT without packets, then the states
+// get the display back.
+class RemoteDisplayService {
+public:
+    enum class PacketType : uint8_t {
+        FRAME,
+        TEXT,
+        END
+    };
+
+    enum class Effect : uint8_t {
+        STATIC,
+        SCROLL,
+        FADE,
+        WAVE,
+        TYPEWRITER,
+        REVEAL,
+        COUNT
+    };
+
+    static constexpr uint16_t UDP_PORT = 4210;
+    static constexpr uint8_t PROTOCOL_VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 6;
+    static constexpr size_t TEXT_MAX = 64;
+
+private:
+    static constexpr size_t PAYLOAD_MAX = 1 + TEXT_MAX;
+    static constexpr uint8_t JITTER_SLOTS = 8;
+    static constexpr uint8_t PREBUFFER = 2;
+    static constexpr unsigned long FRAME_INTERVAL = 50;   // 20 frames per second
+    static constexpr unsigned long IDLE_TIMEOUT = 5000;   // 5 seconds
+
+    struct Slot {
+        uint16_t sequence;
+        PacketType type;
+        uint8_t length;
+        uint8_t payload[PAYLOAD_MAX];
+    };
+
+    IDisplay* display;
+    WiFiUDP udp;
+    bool listening;
+
+    // Jitter buffer, oldest sequence first
+    Slot slots[JITTER_SLOTS];
+    uint8_t slotCount;
+
+    bool active;
+    bool buffering;
+    uint16_t lastSequence;      // Last packet played
+    unsigned long bufferStart;
+    unsigned long lastPlayTime;
+    unsigned long lastPacketTime;
+
+    // Stream statistics, printed when it ends
+    uint32_t playedPackets;
+    uint32_t stalePackets;
+    uint32_t overflowPackets;
+    uint32_t underruns;
+
+    std::function<void(bool active)> onActiveChangeCallback;
+
+public:
+    explicit RemoteDisplayService(IDisplay* display);
+
+    // Listen for UDP packets
+    void begin();
+
+    // Receive and play packets (call from main loop)
+    void update();
+
+    // Queue one packet, from UDP or MQTT. False if it was dropped.
+    bool receive(const uint8_t* packet, size_t length);
+
+    // Whether a stream owns the display
+    bool isActive() const { return active; }
+
+    void onActiveChange(std::function<void(bool active)> callback) {
+        onActiveChangeCallback = callback;
+    }
+
+private:
+    void startStream(uint16_t sequence);
+    void endStream();
+    void play(const Slot& slot);
+    static bool isNewer(uint16_t sequence, uint16_t than);
+};
+
+#endif // REMOTE_DISPLAY_SERVICE_H
@@ -1,5 +1,6 @@
 // services/TimeService.cpp
 #include "TimeService.h"
+#include "WarmState.h"
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
 #include <time.h>
@@ -18,7 +19,7 @@ static void timeSync_cb() {
 }
 
 TimeService::TimeService() 
-    : timeSynced(false), lastSyncAttempt(0), lastUpdateCheck(0) {
+    : timeSynced(false), timeRestored(false), lastSyncAttempt(0), lastUpdateCheck(0), lastSnapshotTime(0) {
 }
 
 TimeService::~TimeService() {
@@ -30,6 +31,10 @@ TimeService::~TimeService() {
 void TimeService::begin() {
     Serial.println("TimeService: Initializing...");
     
+    // Before the sync callback is installed, so the restored time does
+    // not count as synced
+    restoreSnapshot();
+    
     // Set up the time sync callback
     staticTimeSyncCallback = [this]() {
         Serial.println("TimeService: Time synchronized!");
@@ -53,6 +58,12 @@ void TimeService::begin() {
 void TimeService::update() {
     unsigned long currentMillis = millis();
     
+    // Keep the RTC snapshot current for a fast restart
+    if (hasTime() && currentMillis - lastSnapshotTime >= SNAPSHOT_INTERVAL) {
+        lastSnapshotTime = currentMillis;
+        WarmState::captureTime();
+    }
+    
     // Check if we need to sync time
     if (!timeSynced) {
         // Retry sync every SYNC_RETRY_INTERVAL if not synced
@@ -138,4 +149,22 @@ String TimeService::getFormattedDate() const {
     strftime(buffer, sizeof(buffer), "%A %d %B %Y", &timeinfo);
     
     return String(buffer);
+}
+
+bool TimeService::restoreSnapshot() {
+    const WarmState::Data& warmState = WarmState::previous();
+    if (!WarmState::isWarm() || warmState.epoch == 0) {
+        return false;
+    }
+    
+    // The snapshot was taken at most a second before the reset,
+    // add the time spent booting since
+    uint32_t millisSinceEpoch = warmState.epochMillis + millis();
+    timeval tv = { (time_t)(warmState.epoch + millisSinceEpoch / 1000),
+                   (suseconds_t)(millisSinceEpoch % 1000) * 1000 };
+    settimeofday(&tv, nullptr);
+    timeRestored = true;
+    
+    Serial.println("TimeService: Restored time from RTC memory");
+    return true;
 }
\ No newline at end of file
@@ -9,10 +9,13 @@
 class TimeService {
 private:
     bool timeSynced;
+    bool timeRestored;
     unsigned long lastSyncAttempt;
     unsigned long lastUpdateCheck;
+    unsigned long lastSnapshotTime;
     static constexpr unsigned long SYNC_INTERVAL = 3600000; // 1 hour
     static constexpr unsigned long SYNC_RETRY_INTERVAL = 10000; // 10 seconds
+    static constexpr unsigned long SNAPSHOT_INTERVAL = 1000; // 1 second
     
     std::function<void()> onTimeSyncCallback;
     
@@ -30,6 +33,9 @@ public:
     bool syncTime();
     bool isTimeSynced() const { return timeSynced; }
     
+    // Time is synced or was restored from before the last reset
+    bool hasTime() const { return timeSynced || timeRestored; }
+    
     // Callbacks
     void onTimeSync(std::function<void()> callback) { onTimeSyncCallback = callback; }
     
@@ -47,6 +53,9 @@ public:
     TimeInfo getCurrentTime() const;
     String getFormattedTime() const;
     String getFormattedDate() const;
+    
+private:
+    bool restoreSnapshot();
 };
 
 #endif // TIME_SERVICE_H
\ No newline at end of file
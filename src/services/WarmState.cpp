@@ -0,0 +1,68 @@
+// services/WarmState.cpp
+#include "WarmState.h"
+#include <coredecls.h>
+#include <sys/time.h>
+
+// Times before this are an unset clock
+#define MIN_VALID_EPOCH 1600000000UL
+
+static_assert(sizeof(WarmState::Data) % 4 == 0, "RTC memory is accessed in 4-byte blocks");
+
+bool WarmState::warm = false;
+WarmState::Data WarmState::previousData = {};
+WarmState::Data WarmState::currentData = {};
+
+bool WarmState::restore() {
+    Block block;
+    warm = ESP.rtcUserMemoryRead(RTC_OFFSET, (uint32_t*)&block, sizeof(block)) &&
+           block.magic == BLOCK_MAGIC &&
+           block.crc == crc32(&block.data, sizeof(block.data));
+
+    if (warm) {
+        previousData = block.data;
+        Serial.printf("WarmState: Restored, state %u, menu %u/%u\n", previousData.stateType,
+                      previousData.menuIndex, previousData.pendingMenuIndex);
+    } else {
+        previousData = Data();
+        previousData.pendingMenuIndex = 255;
+        Serial.println("WarmState: Cold boot");
+    }
+
+    // Carry everything over until this run updates it
+    currentData = previousData;
+    return warm;
+}
+
+void WarmState::captureTime() {
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+    if ((uint32_t)tv.tv_sec < MIN_VALID_EPOCH) {
+        return;
+    }
+    currentData.epoch = tv.tv_sec;
+    currentData.epochMillis = tv.tv_usec / 1000;
+    save();
+}
+
+void WarmState::setStateType(uint8_t type) {
+    if (currentData.stateType != type) {
+        currentData.stateType = type;
+        save();
+    }
+}
+
+void WarmState::setMenuSelection(uint8_t index, uint8_t pendingIndex) {
+    if (currentData.menuIndex != index || currentData.pendingMenuIndex != pendingIndex) {
+        currentData.menuIndex = index;
+        currentData.pendingMenuIndex = pendingIndex;
+        save();
+    }
+}
+
+void WarmState::save() {
+    Block block;
+    block.magic = BLOCK_MAGIC;
+    block.data = currentData;
+    block.crc = crc32(&block.data, sizeof(block.data));
+    ESP.rtcUserMemoryWrite(RTC_OFFSET, (uint32_t*)&block, sizeof(block));
+}
@@ -0,0 +1,60 @@
+// services/WarmState.h
+#ifndef WARM_STATE_H
+#define WARM_STATE_H
+
+#include <Arduino.h>
+
+// State that survives a soft reset
+//
+// A small CRC protected block in RTC user memory, which keeps its
+// contents across ESP.restart(), OTA reboots and watchdog resets but not
+// across power loss. restore() reads the block left by the previous run
+// once at boot; the setters update the current run's block right away,
+// RTC memory writes are cheap and do not wear the flash.
+//
+// The first 128 bytes of RTC user memory are used by OTA, the block
+// lives behind them.
+class WarmState {
+public:
+    struct Data {
+        uint32_t epoch;          // Last known time, 0 if none
+        uint16_t epochMillis;    // Sub-second part of epoch
+        uint8_t stateType;       // StateType of the active state
+        uint8_t menuIndex;       // Menu cursor
+        uint8_t pendingMenuIndex; // Selection to run on the next press, 255 if none
+        uint8_t reserved[3];
+    };
+
+    // Read the previous run's block, false after power-on or if corrupt
+    static bool restore();
+
+    // Whether restore() found a valid block
+    static bool isWarm() { return warm; }
+
+    // The previous run's state, zeroed on a cold boot
+    static const Data& previous() { return previousData; }
+
+    // Record the system time, if it is set
+    static void captureTime();
+
+    static void setStateType(uint8_t type);
+    static void setMenuSelection(uint8_t index, uint8_t pendingIndex);
+
+private:
+    struct Block {
+        uint32_t magic;
+        Data data;
+        uint32_t crc;
+    };
+
+    static constexpr uint32_t RTC_OFFSET = 32; // In 4-byte blocks, after OTA's area
+    static constexpr uint32_t BLOCK_MAGIC = 0x56575331; // "VWS1"
+
+    static bool warm;
+    static Data previousData;
+    static Data currentData;
+
+    static void save();
+};
+
+#endif // WARM_STATE_H
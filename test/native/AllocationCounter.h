@@ -0,0 +1,31 @@
+// test/native/AllocationCounter.h
+//
+// Replaces the global operator new to count heap allocations, for tests
+// that check a path does not touch the heap. Include it from the test's
+// only translation unit, the operators must be defined once.
+#ifndef HOST_ALLOCATION_COUNTER_H
+#define HOST_ALLOCATION_COUNTER_H
+
+#include <cstdlib>
+#include <new>
+
+// Heap allocations since the start
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* memory = malloc(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+#endif // HOST_ALLOCATION_COUNTER_H
@@ -0,0 +1,266 @@
+// test/native/Arduino.h
+//
+// Host stand-in for the parts of the ESP8266 Arduino core that the code
+// under test uses. Header only, so a test includes the sources it covers
+// and nothing else has to be built. Serial output is dropped unless
+// HOST_SERIAL_ECHO is defined.
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "Esp.h"
+
+using std::max;
+using std::min;
+
+typedef uint8_t byte;
+
+// Flash and RAM are one address space on the host
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define strlen_P strlen
+#define strncmp_P strncmp
+#define memcpy_P memcpy
+
+// Tests move the clock forward instead of waiting
+inline unsigned long hostClockOffset = 0;
+
+inline void advanceMillis(unsigned long ms) {
+    hostClockOffset += ms;
+}
+
+inline unsigned long millis() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return duration_cast<milliseconds>(steady_clock::now() - start).count() + hostClockOffset;
+}
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - start).count() + hostClockOffset * 1000;
+}
+
+inline void yield() {
+}
+
+inline void delay(unsigned long) {
+}
+
+inline void randomSeed(unsigned long seed) {
+    srand(seed);
+}
+
+inline long random(long howBig) {
+    return howBig > 0 ? rand() % howBig : 0;
+}
+
+inline long random(long howSmall, long howBig) {
+    return howSmall < howBig ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+class String {
+public:
+    String() {}
+    String(const char* text) : value(text ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    explicit String(char c) : value(1, c) {}
+    String(int number) : value(std::to_string(number)) {}
+    String(unsigned int number) : value(std::to_string(number)) {}
+    String(long number) : value(std::to_string(number)) {}
+    String(unsigned long number) : value(std::to_string(number)) {}
+
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.length(); }
+    bool isEmpty() const { return value.empty(); }
+    bool reserve(unsigned int size) { value.reserve(size); return true; }
+
+    bool concat(const String& text) { value += text.value; return true; }
+    bool concat(const char* text) { value += text ? text : ""; return true; }
+    bool concat(const char* text, unsigned int length) { value.append(text, length); return true; }
+    bool concat(char c) { value += c; return true; }
+    String& operator+=(const String& text) { concat(text); return *this; }
+    String& operator+=(const char* text) { concat(text); return *this; }
+    String& operator+=(char c) { concat(c); return *this; }
+
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator==(const char* other) const { return value == (other ? other : ""); }
+    bool operator!=(const String& other) const { return value != other.value; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool operator<(const String& other) const { return value < other.value; }
+
+    char operator[](unsigned int index) const { return index < value.size() ? value[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    bool startsWith(const String& prefix) const { return value.compare(0, prefix.value.size(), prefix.value) == 0; }
+    bool endsWith(const String& suffix) const {
+        return value.size() >= suffix.value.size() &&
+               value.compare(value.size() - suffix.value.size(), suffix.value.size(), suffix.value) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return found(value.find(c, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const { return found(value.find(text.value, from)); }
+    int lastIndexOf(char c) const { return found(value.rfind(c)); }
+
+    String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < to && from < value.size() ? String(value.substr(from, to - from)) : String();
+    }
+
+    long toInt() const { return strtol(value.c_str(), nullptr, 10); }
+
+    void trim() {
+        size_t first = value.find_first_not_of(" \t\r\n");
+        size_t last = value.find_last_not_of(" \t\r\n");
+        value = first == std::string::npos ? "" : value.substr(first, last - first + 1);
+    }
+
+private:
+    std::string value;
+
+    static int found(size_t position) { return position == std::string::npos ? -1 : (int)position; }
+};
+
+// The core's type for the result of +, ArduinoJson adapts it as a String
+class StringSumHelper : public String {
+public:
+    using String::String;
+    StringSumHelper(const String& text) : String(text) {}
+};
+
+inline StringSumHelper operator+(const String& left, const String& right) {
+    StringSumHelper sum(left);
+    sum += right;
+    return sum;
+}
+
+inline StringSumHelper operator+(const String& left, const char* right) {
+    return left + String(right);
+}
+
+inline StringSumHelper operator+(const char* left, const String& right) {
+    return String(left) + right;
+}
+
+inline StringSumHelper operator+(const String& left, char right) {
+    StringSumHelper sum(left);
+    sum += right;
+    return sum;
+}
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t length) {
+        size_t written = 0;
+        while (written < length && write(data[written])) {
+            written++;
+        }
+        return written;
+    }
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t write(const char* text, size_t length) { return write((const uint8_t*)text, length); }
+
+    virtual void flush() {}
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int number) { return print(String(number)); }
+    size_t print(unsigned int number) { return print(String(number)); }
+    size_t print(long number) { return print(String(number)); }
+    size_t print(unsigned long number) { return print(String(number)); }
+
+    template <typename T>
+    size_t println(const T& value) { return print(value) + print("\n"); }
+    size_t println() { return print("\n"); }
+
+    // Not checked as a printf format: "%u" for a size_t is right on the
+    // device and would only warn here
+    size_t printf(const char* format, ...) {
+        char buffer[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        return length > 0 ? write((const uint8_t*)buffer, min((size_t)length, sizeof(buffer) - 1)) : 0;
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    virtual size_t readBytes(uint8_t* buffer, size_t length) {
+        size_t count = 0;
+        int c;
+        while (count < length && (c = read()) >= 0) {
+            buffer[count++] = c;
+        }
+        return count;
+    }
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+
+    size_t readBytesUntil(char terminator, char* buffer, size_t length) {
+        size_t count = 0;
+        int c;
+        while (count < length && (c = read()) >= 0 && c != terminator) {
+            buffer[count++] = c;
+        }
+        return count;
+    }
+
+    String readStringUntil(char terminator) {
+        String text;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) {
+            text += (char)c;
+        }
+        return text;
+    }
+
+    String readString() {
+        String text;
+        int c;
+        while ((c = read()) >= 0) {
+            text += (char)c;
+        }
+        return text;
+    }
+};
+
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+
+    size_t write(uint8_t c) override {
+#ifdef HOST_SERIAL_ECHO
+        putchar(c);
+#else
+        (void)c;
+#endif
+        return 1;
+    }
+    using Print::write;
+
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
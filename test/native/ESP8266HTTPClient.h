@@ -0,0 +1,11 @@
+// test/native/ESP8266HTTPClient.h
+//
+// Declarations only, see WiFiClientSecure.h
+#ifndef HOST_ESP8266_HTTP_CLIENT_H
+#define HOST_ESP8266_HTTP_CLIENT_H
+
+#include "ESP8266WiFi.h"
+
+class HTTPClient {};
+
+#endif // HOST_ESP8266_HTTP_CLIENT_H
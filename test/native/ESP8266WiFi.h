@@ -0,0 +1,14 @@
+// test/native/ESP8266WiFi.h
+//
+// Declarations only, see WiFiClientSecure.h
+#ifndef HOST_ESP8266_WIFI_H
+#define HOST_ESP8266_WIFI_H
+
+#include <Arduino.h>
+
+class WiFiClient {
+public:
+    virtual ~WiFiClient() {}
+};
+
+#endif // HOST_ESP8266_WIFI_H
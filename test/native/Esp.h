@@ -0,0 +1,59 @@
+// test/native/Esp.h
+//
+// The ESP object of the core, with the RTC user memory simulated. The
+// memory keeps its contents until simulatePowerLoss(), like the real one
+// across soft resets.
+#ifndef HOST_ESP_H
+#define HOST_ESP_H
+
+#include <cstdint>
+#include <cstring>
+
+class EspClass {
+public:
+    static constexpr size_t RTC_USER_MEMORY_SIZE = 512;
+
+    EspClass() { simulatePowerLoss(); }
+
+    // Offsets are in 4-byte blocks, as on the device
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+        if (!fits(offset, size)) {
+            return false;
+        }
+        memcpy(data, rtcMemory + offset * 4, size);
+        return true;
+    }
+
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+        if (!fits(offset, size)) {
+            return false;
+        }
+        memcpy(rtcMemory + offset * 4, data, size);
+        rtcWrites++;
+        return true;
+    }
+
+    void restart() {}
+
+    // Test helpers: RTC memory comes up with noise after power on
+    void simulatePowerLoss() {
+        for (size_t i = 0; i < RTC_USER_MEMORY_SIZE; i++) {
+            rtcMemory[i] = (uint8_t)(i * 167 + 13);
+        }
+        rtcWrites = 0;
+    }
+    uint8_t* rtcUserMemory() { return rtcMemory; }
+    uint32_t rtcWriteCount() const { return rtcWrites; }
+
+private:
+    uint8_t rtcMemory[RTC_USER_MEMORY_SIZE];
+    uint32_t rtcWrites = 0;
+
+    static bool fits(uint32_t offset, size_t size) {
+        return size > 0 && offset * 4 + size <= RTC_USER_MEMORY_SIZE;
+    }
+};
+
+inline EspClass ESP;
+
+#endif // HOST_ESP_H
@@ -0,0 +1,184 @@
+// test/native/LittleFS.h
+//
+// In-memory LittleFS for host tests, with a rough model of the flash
+// traffic behind it:
+//
+//  - every File::write programs each flash page its bytes touch; a page
+//    that already holds data is programmed again, as a copy
+//  - closing a file that was written commits its metadata, one page
+//  - pages are taken from erased sectors in order, so every
+//    PAGES_PER_SECTOR programs cost one sector erase
+//
+// Good for comparing write patterns, not for predicting wear.
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+struct FlashStats {
+    uint32_t programs = 0; // Page programs
+    uint32_t erases = 0;   // Sector erases
+};
+
+enum SeekMode {
+    SeekSet,
+    SeekCur,
+    SeekEnd
+};
+
+class HostFlash {
+public:
+    static constexpr size_t PAGE_SIZE = 256;
+    static constexpr size_t SECTOR_SIZE = 4096;
+    static constexpr size_t PAGES_PER_SECTOR = SECTOR_SIZE / PAGE_SIZE;
+
+    void program(uint32_t pages) {
+        stats.programs += pages;
+        freshPages += pages;
+        while (freshPages > erasedPages) {
+            stats.erases++;
+            erasedPages += PAGES_PER_SECTOR;
+        }
+    }
+
+    FlashStats stats;
+
+private:
+    uint64_t freshPages = 0;  // Pages programmed since the start
+    uint64_t erasedPages = 0; // Pages made available by erases
+};
+
+class File : public Stream {
+public:
+    File() {}
+    File(std::shared_ptr<std::vector<uint8_t>> data, HostFlash* flash, const String& path, bool writable, bool append)
+        : data(data), flash(flash), path(path), writable(writable), offset(append ? data->size() : 0) {}
+
+    explicit operator bool() const { return (bool)data; }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* bytes, size_t length) override {
+        if (!data || !writable) {
+            return 0;
+        }
+        if (offset + length > data->size()) {
+            data->resize(offset + length);
+        }
+        memcpy(data->data() + offset, bytes, length);
+        if (length) {
+            flash->program((offset + length + HostFlash::PAGE_SIZE - 1) / HostFlash::PAGE_SIZE -
+                           offset / HostFlash::PAGE_SIZE);
+            dirty = true;
+        }
+        offset += length;
+        return length;
+    }
+    using Print::write;
+
+    int available() override { return data && offset < data->size() ? data->size() - offset : 0; }
+    int read() override { return available() ? (*data)[offset++] : -1; }
+    int peek() override { return available() ? (*data)[offset] : -1; }
+    size_t read(uint8_t* buffer, size_t length) { return readBytes(buffer, length); }
+    size_t readBytes(uint8_t* buffer, size_t length) override {
+        size_t count = min(length, (size_t)available());
+        if (count) {
+            memcpy(buffer, data->data() + offset, count);
+            offset += count;
+        }
+        return count;
+    }
+    using Stream::readBytes;
+
+    bool seek(uint32_t position, SeekMode mode = SeekSet) {
+        if (!data) {
+            return false;
+        }
+        size_t base = mode == SeekSet ? 0 : mode == SeekCur ? offset : data->size();
+        if (base + position > data->size()) {
+            return false;
+        }
+        offset = base + position;
+        return true;
+    }
+
+    size_t position() const { return offset; }
+    size_t size() const { return data ? data->size() : 0; }
+    const char* name() const { return path.c_str(); }
+
+    void close() {
+        if (data && dirty) {
+            flash->program(1);
+        }
+        data.reset();
+        dirty = false;
+    }
+
+private:
+    std::shared_ptr<std::vector<uint8_t>> data;
+    HostFlash* flash = nullptr;
+    String path;
+    bool writable = false;
+    bool dirty = false;
+    size_t offset = 0;
+};
+
+class HostFS {
+public:
+    bool begin() { return true; }
+    void end() {}
+    bool format() { files.clear(); return true; }
+
+    File open(const String& path, const char* mode) {
+        operations++;
+        std::string key = path.c_str();
+        auto it = files.find(key);
+        if (mode[0] == 'r' && mode[1] != '+') {
+            return it == files.end() ? File() : File(it->second, &flash, path, false, false);
+        }
+        if (it == files.end() || mode[0] == 'w') {
+            // A new or truncated file gets new storage, readers keep the old
+            files[key] = std::make_shared<std::vector<uint8_t>>();
+            it = files.find(key);
+        }
+        return File(it->second, &flash, path, true, mode[0] == 'a');
+    }
+
+    bool exists(const String& path) {
+        operations++;
+        return files.count(path.c_str()) > 0;
+    }
+
+    bool remove(const String& path) {
+        operations++;
+        return files.erase(path.c_str()) > 0;
+    }
+
+    bool rename(const String& from, const String& to) {
+        operations++;
+        auto it = files.find(from.c_str());
+        if (it == files.end()) {
+            return false;
+        }
+        files[to.c_str()] = it->second;
+        files.erase(it);
+        return true;
+    }
+
+    // Test helpers
+    const FlashStats& flashStats() const { return flash.stats; }
+    uint32_t fileOperations() const { return operations; } // open, exists, remove, rename
+    void resetFlashStats() { flash.stats = FlashStats(); }
+    void clear() { files.clear(); }
+
+private:
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+    HostFlash flash;
+    uint32_t operations = 0;
+};
+
+inline HostFS LittleFS;
+
+#endif // HOST_LITTLEFS_H
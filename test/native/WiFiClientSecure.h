@@ -0,0 +1,18 @@
+// test/native/WiFiClientSecure.h
+//
+// Declarations only, so headers that hold clients compile; nothing
+// connects on the host
+#ifndef HOST_WIFI_CLIENT_SECURE_H
+#define HOST_WIFI_CLIENT_SECURE_H
+
+#include "ESP8266WiFi.h"
+
+namespace BearSSL {
+class Session {};
+class PublicKey {};
+class X509List {};
+}
+
+class WiFiClientSecure : public WiFiClient {};
+
+#endif // HOST_WIFI_CLIENT_SECURE_H
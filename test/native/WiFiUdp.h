@@ -0,0 +1,18 @@
+// test/native/WiFiUdp.h
+//
+// A socket that never receives anything, tests hand packets to the code
+// under test directly
+#ifndef HOST_WIFI_UDP_H
+#define HOST_WIFI_UDP_H
+
+#include <Arduino.h>
+
+class WiFiUDP {
+public:
+    uint8_t begin(uint16_t) { return 1; }
+    int parsePacket() { return 0; }
+    int read(uint8_t*, size_t) { return 0; }
+    void flush() {}
+};
+
+#endif // HOST_WIFI_UDP_H
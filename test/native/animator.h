@@ -0,0 +1,34 @@
+// test/native/animator.h
+//
+// Records the effects started instead of running them. A test sets
+// running to hold callers that wait for the animation to end.
+#ifndef HOST_ANIMATOR_H
+#define HOST_ANIMATOR_H
+
+#include <Arduino.h>
+#include <gui.h>
+
+class Animator {
+public:
+    String effect;   // Last effect started
+    String text;
+    bool running = false;
+
+    void set_segments_and_run(const char* intro, const char*, uint8_t = 210, uint8_t = 1) { started("scroll", intro); }
+    void start_fade_in(const char* text, uint8_t = 120) { started("fade", text); }
+    void start_wave_effect(const char* text, uint8_t = 100) { started("wave", text); }
+    void start_typewriter_effect(const char* text, uint8_t = 200) { started("typewriter", text); }
+    void start_reveal_effect(const char* text, uint8_t = 150) { started("reveal", text); }
+
+    void stop() { running = false; }
+    bool is_running() { return running; }
+
+private:
+    void started(const char* name, const char* shown) {
+        effect = name;
+        text = shown;
+        running = true;
+    }
+};
+
+#endif // HOST_ANIMATOR_H
@@ -0,0 +1,21 @@
+// test/native/coredecls.h
+//
+// The core's crc32, CRC-32 as used for Ethernet and zip
+#ifndef HOST_COREDECLS_H
+#define HOST_COREDECLS_H
+
+#include <cstddef>
+#include <cstdint>
+
+inline uint32_t crc32(const void* data, size_t length, uint32_t crc = 0xffffffff) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (length--) {
+        crc ^= *bytes++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+#endif // HOST_COREDECLS_H
@@ -0,0 +1,12 @@
+// test/native/gui.h
+//
+// The display geometry of lib/gui/gui.h, without the PT6315 driver
+#ifndef HOST_GUI_H
+#define HOST_GUI_H
+
+#include <Arduino.h>
+
+#define VFD_DIG_LEN 6
+#define VFD_FRAME_LEN 24
+
+#endif // HOST_GUI_H
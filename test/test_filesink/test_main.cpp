@@ -0,0 +1,165 @@
+// test_filesink/test_main.cpp
+//
+// FileSink against the simulated flash of test/native/LittleFS.h: the
+// data arrives intact, appends stay page aligned and a sync written
+// through the sink programs and erases less than direct writes.
+#include <unity.h>
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../../lib/store/filesink.h"
+
+// The native env does not build lib/, the unit under test comes along
+#include "../../lib/store/filesink.cpp"
+
+// A simulated sync: three files, written in TCP segment sized pieces as
+// downloads are, or in record sized pieces as ingest and Kiwi write
+static const size_t SYNC_FILES = 3;
+static const size_t SYNC_FILE_SIZE = 20000;
+static const size_t SEGMENT_SIZE = 1460;
+static const size_t RECORD_SIZE = 64;
+
+static uint8_t pattern(size_t i) {
+    return (i * 31 + 7) & 0xFF;
+}
+
+static void fill(uint8_t* data, size_t offset, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        data[i] = pattern(offset + i);
+    }
+}
+
+static void checkContent(const char* path, size_t expected) {
+    File file = LittleFS.open(path, "r");
+    TEST_ASSERT_TRUE(file);
+    TEST_ASSERT_EQUAL(expected, file.size());
+    for (size_t i = 0; i < expected; i++) {
+        if (file.read() != pattern(i)) {
+            TEST_ASSERT_EQUAL_MESSAGE(pattern(i), -1, "content differs");
+        }
+    }
+    file.close();
+}
+
+// Write a sync directly to the files or through a sink, return the flash
+// traffic it caused
+static FlashStats sync(bool buffered, size_t pieceSize) {
+    LittleFS.resetFlashStats();
+    FileSink::resetStats();
+    uint8_t segment[SEGMENT_SIZE];
+    for (size_t f = 0; f < SYNC_FILES; f++) {
+        String path = "/asset" + String((int)f) + ".txt";
+        FileSink sink;
+        File direct;
+        if (buffered) {
+            sink.open(path, "w");
+        } else {
+            direct = LittleFS.open(path, "w");
+        }
+        for (size_t offset = 0; offset < SYNC_FILE_SIZE; offset += pieceSize) {
+            size_t length = min(pieceSize, SYNC_FILE_SIZE - offset);
+            fill(segment, offset, length);
+            if (buffered) {
+                sink.write(segment, length);
+            } else {
+                direct.write(segment, length);
+            }
+        }
+        sink.close();
+        direct.close();
+        checkContent(path.c_str(), SYNC_FILE_SIZE);
+    }
+    return LittleFS.flashStats();
+}
+
+void setUp() {
+    LittleFS.clear();
+    LittleFS.resetFlashStats();
+    FileSink::resetStats();
+}
+
+void tearDown() {
+}
+
+void test_odd_writes_arrive_intact() {
+    FileSink sink;
+    TEST_ASSERT_TRUE(sink.open("/odd.bin", "w"));
+    uint8_t data[700];
+    size_t offset = 0;
+    for (size_t length : {1, 255, 256, 257, 700, 3, 511}) {
+        fill(data, offset, length);
+        TEST_ASSERT_EQUAL(length, sink.write(data, length));
+        offset += length;
+    }
+
+    // Filled in place, as downloads do
+    uint8_t* space;
+    size_t length = min(sink.reserve(space), (size_t)100);
+    fill(space, offset, length);
+    sink.commit(length);
+    offset += length;
+
+    TEST_ASSERT_EQUAL(offset, sink.size());
+    sink.close();
+    TEST_ASSERT_FALSE(sink.failed());
+    checkContent("/odd.bin", offset);
+}
+
+void test_append_stays_page_aligned() {
+    File file = LittleFS.open("/append.bin", "w");
+    uint8_t data[2000];
+    fill(data, 0, 300);
+    file.write(data, 300);
+    file.close();
+
+    FileSink::resetStats();
+    FileSink sink;
+    TEST_ASSERT_TRUE(sink.open("/append.bin", "a"));
+    for (size_t offset = 300; offset < 2300; offset += 100) {
+        fill(data, offset, 100);
+        sink.write(data, 100);
+    }
+    sink.close();
+    checkContent("/append.bin", 2300);
+
+    // Bytes 300..2299 touch pages 1..8, each exactly once: the first
+    // flush stops at the boundary of page 4, close() writes the rest
+    TEST_ASSERT_EQUAL_UINT32(2000, FileSink::stats().bytes);
+    TEST_ASSERT_EQUAL_UINT32(8, FileSink::stats().pages);
+    TEST_ASSERT_EQUAL_UINT32(2, FileSink::stats().writes);
+}
+
+static void checkSync(size_t pieceSize) {
+    FlashStats direct = sync(false, pieceSize);
+    FlashStats buffered = sync(true, pieceSize);
+
+    char report[160];
+    snprintf(report, sizeof(report),
+             "Sync of %u x %u bytes in %u byte writes: direct %u programs %u erases, sink %u programs %u erases",
+             (unsigned)SYNC_FILES, (unsigned)SYNC_FILE_SIZE, (unsigned)pieceSize,
+             direct.programs, direct.erases, buffered.programs, buffered.erases);
+    TEST_MESSAGE(report);
+
+    // The sink touches each data page once, plus the metadata on close
+    uint32_t dataPages = SYNC_FILES * ((SYNC_FILE_SIZE + HostFlash::PAGE_SIZE - 1) / HostFlash::PAGE_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(dataPages, FileSink::stats().pages);
+    TEST_ASSERT_EQUAL_UINT32(dataPages + SYNC_FILES, buffered.programs);
+    TEST_ASSERT_LESS_THAN_UINT32(direct.programs, buffered.programs);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(direct.erases, buffered.erases);
+}
+
+void test_download_sync_programs_less_through_sink() {
+    checkSync(SEGMENT_SIZE);
+}
+
+void test_record_sync_programs_less_through_sink() {
+    checkSync(RECORD_SIZE);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_odd_writes_arrive_intact);
+    RUN_TEST(test_append_stays_page_aligned);
+    RUN_TEST(test_download_sync_programs_less_through_sink);
+    RUN_TEST(test_record_sync_programs_less_through_sink);
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+// test_gestures/test_main.cpp
+//
+// Replays recorded edge timings through ButtonGestures and checks the
+// gestures it reports. Run with `pio test -e native`.
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "hal/ButtonGestures.h"
+#include "hal/SpscRing.h"
+
+// The native env does not build src/, the unit under test comes along
+#include "hal/ButtonGestures.cpp"
+
+struct Edge {
+    bool pressed;
+    uint32_t time;
+};
+
+static const char* const EVENT_NAMES[] = {"SHORT", "LONG", "HOLD", "DOUBLE", "TRIPLE", "CLICKHOLD"};
+
+static std::string events;
+
+// Feed the edges as a polling loop with the given period would see them,
+// return the gestures reported, space separated
+static std::string replay(const std::vector<Edge>& edges, uint32_t end, uint32_t pollInterval) {
+    events.clear();
+    ButtonGestures gestures([](ButtonEvent event) {
+        events += events.empty() ? "" : " ";
+        events += EVENT_NAMES[static_cast<int>(event)];
+    });
+    gestures.reset(false, 0);
+
+    size_t next = 0;
+    for (uint32_t now = 0; now <= end; now += pollInterval) {
+        while (next < edges.size() && edges[next].time <= now) {
+            gestures.edge(edges[next].pressed, edges[next].time);
+            next++;
+        }
+        gestures.poll(now);
+    }
+    return events;
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+// Contact bounce at both ends of a short press
+static const std::vector<Edge> BOUNCY_CLICK = {{1, 100}, {0, 102}, {1, 104}, {0, 220}, {1, 223}, {0, 226}};
+
+void test_click() {
+    TEST_ASSERT_EQUAL_STRING("SHORT", replay(BOUNCY_CLICK, 2000, 10).c_str());
+}
+
+void test_click_does_not_depend_on_poll_rate() {
+    for (uint32_t interval : {1u, 10u, 100u, 600u}) {
+        TEST_ASSERT_EQUAL_STRING("SHORT", replay(BOUNCY_CLICK, 2000, interval).c_str());
+    }
+}
+
+void test_glitch_is_ignored() {
+    TEST_ASSERT_EQUAL_STRING("", replay({{1, 100}, {0, 105}}, 1000, 1).c_str());
+}
+
+void test_double_click() {
+    const std::vector<Edge> edges = {{1, 100}, {0, 200}, {1, 400}, {0, 500}};
+    for (uint32_t interval : {1u, 10u, 700u}) {
+        TEST_ASSERT_EQUAL_STRING("DOUBLE", replay(edges, 2000, interval).c_str());
+    }
+}
+
+void test_clicks_outside_window_are_separate() {
+    const std::vector<Edge> edges = {{1, 100}, {0, 200}, {1, 500}, {0, 600}};
+    TEST_ASSERT_EQUAL_STRING("SHORT SHORT", replay(edges, 2000, 10).c_str());
+}
+
+void test_triple_click() {
+    const std::vector<Edge> edges = {{1, 100}, {0, 200}, {1, 300}, {0, 400}, {1, 500}, {0, 600}};
+    TEST_ASSERT_EQUAL_STRING("TRIPLE", replay(edges, 2000, 10).c_str());
+}
+
+void test_fourth_click_starts_over() {
+    const std::vector<Edge> edges = {{1, 100}, {0, 200}, {1, 300}, {0, 400},
+                                     {1, 500}, {0, 600}, {1, 700}, {0, 800}};
+    TEST_ASSERT_EQUAL_STRING("TRIPLE SHORT", replay(edges, 2000, 10).c_str());
+}
+
+void test_hold_repeats_until_release() {
+    TEST_ASSERT_EQUAL_STRING("HOLD HOLD HOLD LONG", replay({{1, 100}, {0, 2000}}, 4000, 10).c_str());
+}
+
+void test_hold_repeats_missed_in_a_stall_are_skipped() {
+    TEST_ASSERT_EQUAL_STRING("HOLD LONG", replay({{1, 100}, {0, 2000}}, 4000, 3000).c_str());
+}
+
+void test_hold_repeats_speed_up() {
+    std::vector<uint32_t> times;
+    uint32_t now = 0;
+    ButtonGestures gestures([&](ButtonEvent event) {
+        if (event == ButtonEvent::LONG_PRESS_HOLD) {
+            times.push_back(now);
+        }
+    });
+    gestures.reset(false, 0);
+    gestures.edge(true, 0);
+    for (now = 0; now < 10000 && times.size() < 20; now++) {
+        gestures.poll(now);
+    }
+
+    TEST_ASSERT_EQUAL(20, times.size());
+    TEST_ASSERT_EQUAL_UINT32(ButtonGestures::LONG_PRESS_TIME, times[0]);
+    TEST_ASSERT_EQUAL_UINT32(ButtonGestures::LONG_PRESS_TIME + ButtonGestures::HOLD_INTERVAL, times[1]);
+    for (size_t i = 2; i < times.size(); i++) {
+        uint32_t interval = times[i] - times[i - 1];
+        TEST_ASSERT_LESS_OR_EQUAL(times[i - 1] - times[i - 2], interval);
+        TEST_ASSERT_GREATER_THAN(ButtonGestures::HOLD_INTERVAL_MIN - 1, interval);
+    }
+    TEST_ASSERT_EQUAL_UINT32(ButtonGestures::HOLD_INTERVAL_MIN, times[19] - times[18]);
+}
+
+void test_click_hold() {
+    const std::vector<Edge> edges = {{1, 100}, {0, 200}, {1, 300}, {0, 1500}};
+    TEST_ASSERT_EQUAL_STRING("CLICKHOLD LONG", replay(edges, 3000, 10).c_str());
+}
+
+void test_double_click_hold() {
+    const std::vector<Edge> edges = {{1, 100}, {0, 200}, {1, 300}, {0, 400}, {1, 500}, {0, 2500}};
+    TEST_ASSERT_EQUAL_STRING("CLICKHOLD LONG", replay(edges, 3000, 10).c_str());
+}
+
+// The interrupt side's queue: full when SIZE edges wait, order kept
+// across the index wrap
+void test_edge_ring_wraps() {
+    SpscRing<Edge, 4> ring;
+    Edge edge;
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring.push({true, i}));
+    }
+    TEST_ASSERT_FALSE(ring.push({true, 99}));
+
+    for (uint32_t i = 0; i < 300; i++) {
+        TEST_ASSERT_TRUE(ring.pop(edge));
+        TEST_ASSERT_EQUAL_UINT32(i, edge.time);
+        TEST_ASSERT_TRUE(ring.push({true, i + 4}));
+    }
+    TEST_ASSERT_FALSE(ring.empty());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_click);
+    RUN_TEST(test_click_does_not_depend_on_poll_rate);
+    RUN_TEST(test_glitch_is_ignored);
+    RUN_TEST(test_double_click);
+    RUN_TEST(test_clicks_outside_window_are_separate);
+    RUN_TEST(test_triple_click);
+    RUN_TEST(test_fourth_click_starts_over);
+    RUN_TEST(test_hold_repeats_until_release);
+    RUN_TEST(test_hold_repeats_missed_in_a_stall_are_skipped);
+    RUN_TEST(test_hold_repeats_speed_up);
+    RUN_TEST(test_click_hold);
+    RUN_TEST(test_double_click_hold);
+    RUN_TEST(test_edge_ring_wraps);
+    return UNITY_END();
+}
@@ -0,0 +1,250 @@
+// test_menu/test_main.cpp
+//
+// Entering the menu 1000 times: the items are loaded on the first entry
+// only, later entries neither allocate nor touch the file system. The
+// time per entry is reported, not checked. Invalidating reloads once,
+// without duplicating items. Picks leave the flash alone until the
+// picker state is saved, and a text file left over is ingested on load
+// rather than looked up per pick. A damaged store falls back to the text
+// file, and the shuffle covers the records of the store even where
+// data.json counts fewer.
+#include <unity.h>
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <AllocationCounter.h>
+#include <chrono>
+#include <set>
+#include "../../lib/store/menuhandler.h"
+#include "../../lib/store/filedownload.h"
+
+// The native env does not build lib/, the units under test come along
+#include "../../lib/store/menuhandler.cpp"
+#include "../../lib/store/recordstore.cpp"
+#include "../../lib/store/recordpicker.cpp"
+#include "../../lib/store/filesink.cpp"
+
+// The host has no network, a missing data.json stays missing
+FileDownloader::FileDownloader() {}
+FileDownloader::~FileDownloader() {}
+bool FileDownloader::downloadFile(const char*, const char*) { return false; }
+
+static const int ENTRIES = 1000;
+static const int TIMING_WINDOW = 100;
+
+static const char* const DATA_JSON = R"([
+    {"menu": "zufall", "intro": "", "numrec": 0, "type": "random"},
+    {"menu": "po", "intro": "PO sagt...", "numrec": 3, "type": "file"},
+    {"menu": "ceo", "intro": "CEO sagt...", "numrec": 2, "type": "file"},
+    {"menu": "8ball", "intro": "8-Ball sagt...", "numrec": 2, "type": "file"},
+    {"menu": "config", "intro": "", "numrec": 0, "type": "config"}
+])";
+
+static void writeFile(const char* path, const char* text) {
+    File file = LittleFS.open(path, "w");
+    file.write((const uint8_t*)text, strlen(text));
+    file.close();
+}
+
+// Assets as a finished sync leaves them, text files ingested
+static void writeAssets(const char* dataJson) {
+    writeFile(DATA_FILENAME, dataJson);
+    writeFile("po.txt", "Eins\nZwei\nDrei\n");
+    writeFile("ceo.txt", "Umsatz\nGewinn\n");
+    writeFile("8ball.txt", "Ja\nNein\n");
+    for (const char* file : {"po.txt", "ceo.txt", "8ball.txt"}) {
+        RecordStore::ingest(file, RecordStore::storeNameFor(file).c_str());
+    }
+}
+
+// What MenuState::onEnter and loadMenu() do with the handler
+static bool enterMenu(MenuHandler& handler) {
+    if (!handler.isLoaded()) {
+        if (!handler.begin()) {
+            return false;
+        }
+        handler.initializeMenuItems();
+    }
+    handler.setCurrentMenuIndex(0);
+    return handler.isLoaded();
+}
+
+void setUp() {
+    LittleFS.clear();
+    writeAssets(DATA_JSON);
+}
+
+void tearDown() {
+}
+
+void test_entries_after_the_first_are_free() {
+    MenuHandler handler;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    size_t items = handler.getMenuItems().size();
+    TEST_ASSERT_EQUAL(5, items);
+
+    size_t allocationsBefore = allocations;
+    uint32_t operationsBefore = LittleFS.fileOperations();
+    double windowNanos[2] = {0, 0};
+    for (int i = 0; i < ENTRIES; i++) {
+        handler.scrollToNextItem();
+        auto start = std::chrono::steady_clock::now();
+        TEST_ASSERT_TRUE(enterMenu(handler));
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (i < TIMING_WINDOW) {
+            windowNanos[0] += nanos;
+        } else if (i >= ENTRIES - TIMING_WINDOW) {
+            windowNanos[1] += nanos;
+        }
+    }
+
+    char report[128];
+    snprintf(report, sizeof(report), "Menu entry: %.0f ns over the first %d, %.0f ns over the last %d (host)",
+             windowNanos[0] / TIMING_WINDOW, TIMING_WINDOW, windowNanos[1] / TIMING_WINDOW, TIMING_WINDOW);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_EQUAL(items, handler.getMenuItems().size());
+    TEST_ASSERT_EQUAL(0, handler.getCurrentMenuIndex());
+    TEST_ASSERT_EQUAL(0, allocations - allocationsBefore);
+    TEST_ASSERT_EQUAL_UINT32(operationsBefore, LittleFS.fileOperations());
+}
+
+void test_invalidate_reloads_once() {
+    MenuHandler handler;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+
+    handler.invalidate();
+    TEST_ASSERT_FALSE(handler.isLoaded());
+    size_t allocationsBefore = allocations;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    TEST_ASSERT_GREATER_THAN(0, allocations - allocationsBefore);
+    TEST_ASSERT_EQUAL(5, handler.getMenuItems().size());
+
+    allocationsBefore = allocations;
+    for (int i = 0; i < ENTRIES; i++) {
+        enterMenu(handler);
+    }
+    TEST_ASSERT_EQUAL(0, allocations - allocationsBefore);
+}
+
+void test_reload_picks_up_changed_assets() {
+    MenuHandler handler;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+
+    std::string changed = DATA_JSON;
+    changed.insert(changed.rfind(']'), R"(,{"menu": "arch", "intro": "", "numrec": 1, "type": "file"})");
+    writeFile(DATA_FILENAME, changed.c_str());
+
+    // Unchanged until the sync reports it
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    TEST_ASSERT_EQUAL(5, handler.getMenuItems().size());
+
+    handler.invalidate();
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    TEST_ASSERT_EQUAL(6, handler.getMenuItems().size());
+    TEST_ASSERT_EQUAL_STRING(" arch", handler.getMenuItems().back().menu.c_str());
+}
+
+void test_missing_assets_fail_without_caching() {
+    LittleFS.clear();
+    MenuHandler handler;
+    TEST_ASSERT_FALSE(enterMenu(handler));
+
+    writeAssets(DATA_JSON);
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    TEST_ASSERT_EQUAL(5, handler.getMenuItems().size());
+}
+
+void test_picks_are_saved_in_batches() {
+    MenuHandler handler;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    const MenuItem& item = handler.getMenuItems()[1];
+    char buffer[RECORD_MAX_LENGTH + 1];
+
+    LittleFS.resetFlashStats();
+    for (int i = 0; i < ENTRIES; i++) {
+        TEST_ASSERT_TRUE(handler.getRandomRecord(item, buffer, sizeof(buffer)));
+        handler.updatePicker();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, LittleFS.flashStats().programs);
+    TEST_ASSERT_FALSE(LittleFS.exists("/picker.bin"));
+
+    handler.savePicker();
+    TEST_ASSERT_TRUE(LittleFS.exists("/picker.bin"));
+    uint32_t programs = LittleFS.flashStats().programs;
+    TEST_ASSERT_GREATER_THAN(0, programs);
+
+    // Nothing new to write
+    handler.savePicker();
+    TEST_ASSERT_EQUAL_UINT32(programs, LittleFS.flashStats().programs);
+}
+
+void test_leftover_text_is_ingested_on_load() {
+    writeFile("ceo.txt", "Umsatz\nGewinn\nMarge\n");
+    MenuHandler handler;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    TEST_ASSERT_FALSE(LittleFS.exists("ceo.txt"));
+    TEST_ASSERT_TRUE(LittleFS.exists(RecordStore::storeNameFor("ceo.txt")));
+
+    // The first pick opens the store, the rest only seek in it
+    const MenuItem& item = handler.getMenuItems()[2];
+    char buffer[RECORD_MAX_LENGTH + 1];
+    TEST_ASSERT_TRUE(handler.getRandomRecord(item, buffer, sizeof(buffer)));
+    uint32_t operationsBefore = LittleFS.fileOperations();
+    for (int i = 0; i < ENTRIES; i++) {
+        TEST_ASSERT_TRUE(handler.getRandomRecord(item, buffer, sizeof(buffer)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(operationsBefore, LittleFS.fileOperations());
+}
+
+void test_damaged_store_falls_back_to_text() {
+    MenuHandler handler;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+
+    // Header and index intact, the compressed data cut off
+    File store = LittleFS.open(RecordStore::storeNameFor("po.txt"), "r");
+    std::string head(8 + (3 + 1) * 4, '\0');
+    store.read((uint8_t*)&head[0], head.size());
+    store.close();
+    File truncated = LittleFS.open(RecordStore::storeNameFor("po.txt"), "w");
+    truncated.write((const uint8_t*)head.data(), head.size());
+    truncated.close();
+    writeFile("po.txt", "Eins\nZwei\nDrei\n");
+
+    const MenuItem& item = handler.getMenuItems()[1];
+    char buffer[RECORD_MAX_LENGTH + 1];
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(handler.getRandomRecord(item, buffer, sizeof(buffer)));
+        TEST_ASSERT_TRUE(strcmp(buffer, "Eins") == 0 || strcmp(buffer, "Zwei") == 0 || strcmp(buffer, "Drei") == 0);
+    }
+}
+
+void test_shuffle_follows_the_store() {
+    // data.json still says 3
+    writeFile("po.txt", "Eins\nZwei\nDrei\nVier\nFuenf\n");
+    MenuHandler handler;
+    TEST_ASSERT_TRUE(enterMenu(handler));
+    const MenuItem& item = handler.getMenuItems()[1];
+    TEST_ASSERT_EQUAL(5, item.numrec);
+
+    // One cycle hands out every record once
+    std::set<std::string> seen;
+    char buffer[RECORD_MAX_LENGTH + 1];
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(handler.getRandomRecord(item, buffer, sizeof(buffer)));
+        seen.insert(buffer);
+    }
+    TEST_ASSERT_EQUAL(5, seen.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_entries_after_the_first_are_free);
+    RUN_TEST(test_invalidate_reloads_once);
+    RUN_TEST(test_reload_picks_up_changed_assets);
+    RUN_TEST(test_missing_assets_fail_without_caching);
+    RUN_TEST(test_picks_are_saved_in_batches);
+    RUN_TEST(test_leftover_text_is_ingested_on_load);
+    RUN_TEST(test_damaged_store_falls_back_to_text);
+    RUN_TEST(test_shuffle_follows_the_store);
+    return UNITY_END();
+}
@@ -0,0 +1,252 @@
+// test_remote_display/test_main.cpp
+//
+// Feeds packets to RemoteDisplayService and checks what reaches the
+// display: sequence ordering, stale and overflowing packets, the
+// prebuffer and the end of a stream.
+#include <unity.h>
+#include <Arduino.h>
+#include <memory>
+#include <vector>
+#include "services/RemoteDisplayService.h"
+#include "hal/IDisplay.h"
+
+// The native env does not build src/, the unit under test comes along
+#include "services/RemoteDisplayService.cpp"
+
+Animator globalAnimator;
+
+// RemoteDisplayService::FRAME_INTERVAL and IDLE_TIMEOUT
+static const unsigned long FRAME_MS = 50;
+static const unsigned long IDLE_MS = 5000;
+
+// Sequence numbers of the frames written, frames carry theirs in byte 0
+static std::vector<int> played;
+static int clears = 0;
+
+class TestDisplay : public IDisplay {
+public:
+    void setText(const std::string&) override {}
+    void setCharAt(size_t, char) override {}
+    void clear() override { clears++; }
+    void writeFrame(const uint8_t* frame, size_t) override { played.push_back(frame[0]); }
+    void setIcon(DisplayIcon, bool) override {}
+    void clearIcons() override {}
+    void setBrightness(uint8_t) override {}
+    void setColon(uint8_t, bool) override {}
+    void setFilament(uint8_t) override {}
+    void powerOn() override {}
+    void powerOff() override {}
+};
+
+static TestDisplay display;
+static std::unique_ptr<RemoteDisplayService> service;
+static std::vector<bool> activeChanges;
+
+static bool send(RemoteDisplayService::PacketType type, uint16_t sequence,
+                 const uint8_t* payload, size_t length) {
+    uint8_t packet[RemoteDisplayService::HEADER_SIZE + VFD_FRAME_LEN + RemoteDisplayService::TEXT_MAX];
+    packet[0] = 'V';
+    packet[1] = 'F';
+    packet[2] = RemoteDisplayService::PROTOCOL_VERSION;
+    packet[3] = static_cast<uint8_t>(type);
+    packet[4] = sequence >> 8;
+    packet[5] = sequence & 0xFF;
+    if (length) {
+        memcpy(packet + RemoteDisplayService::HEADER_SIZE, payload, length);
+    }
+    return service->receive(packet, RemoteDisplayService::HEADER_SIZE + length);
+}
+
+static bool sendFrame(uint16_t sequence) {
+    uint8_t frame[VFD_FRAME_LEN] = {};
+    frame[0] = sequence & 0xFF;
+    return send(RemoteDisplayService::PacketType::FRAME, sequence, frame, sizeof(frame));
+}
+
+// Let the given number of frame intervals pass, one update each
+static void run(int intervals) {
+    for (int i = 0; i < intervals; i++) {
+        advanceMillis(FRAME_MS);
+        service->update();
+    }
+}
+
+void setUp() {
+    played.clear();
+    clears = 0;
+    activeChanges.clear();
+    globalAnimator = Animator();
+    service.reset(new RemoteDisplayService(&display));
+    service->onActiveChange([](bool active) { activeChanges.push_back(active); });
+}
+
+void tearDown() {
+    service.reset();
+}
+
+void test_frames_play_in_sequence_order() {
+    TEST_ASSERT_TRUE(sendFrame(1));
+    TEST_ASSERT_TRUE(sendFrame(3));
+    TEST_ASSERT_TRUE(sendFrame(2));
+    TEST_ASSERT_TRUE(service->isActive());
+
+    run(3);
+    TEST_ASSERT_EQUAL(3, played.size());
+    TEST_ASSERT_EQUAL(1, played[0]);
+    TEST_ASSERT_EQUAL(2, played[1]);
+    TEST_ASSERT_EQUAL(3, played[2]);
+}
+
+void test_one_frame_per_interval() {
+    for (uint16_t sequence = 1; sequence <= 4; sequence++) {
+        sendFrame(sequence);
+    }
+    run(1);
+    service->update();
+    service->update();
+    TEST_ASSERT_EQUAL(1, played.size());
+    run(1);
+    TEST_ASSERT_EQUAL(2, played.size());
+}
+
+void test_stale_packets_are_dropped() {
+    sendFrame(10);
+    sendFrame(11);
+    run(2);
+    TEST_ASSERT_EQUAL(2, played.size());
+
+    // Already played, and a duplicate of one still waiting
+    TEST_ASSERT_FALSE(sendFrame(10));
+    TEST_ASSERT_TRUE(sendFrame(13));
+    TEST_ASSERT_FALSE(sendFrame(13));
+    TEST_ASSERT_TRUE(sendFrame(12));
+
+    run(4);
+    TEST_ASSERT_EQUAL(4, played.size());
+    TEST_ASSERT_EQUAL(12, played[2]);
+    TEST_ASSERT_EQUAL(13, played[3]);
+}
+
+void test_sequence_wraps_around() {
+    sendFrame(0xFFFE);
+    sendFrame(0xFFFF);
+    TEST_ASSERT_TRUE(sendFrame(0));
+    TEST_ASSERT_TRUE(sendFrame(1));
+    run(4);
+    TEST_ASSERT_EQUAL(4, played.size());
+    TEST_ASSERT_EQUAL(0xFE, played[0]);
+    TEST_ASSERT_EQUAL(0, played[2]);
+    TEST_ASSERT_EQUAL(1, played[3]);
+}
+
+void test_overflow_skips_the_oldest() {
+    // Eight slots, the ninth packet pushes out the first
+    TEST_ASSERT_TRUE(sendFrame(1));
+    for (uint16_t sequence = 3; sequence <= 10; sequence++) {
+        TEST_ASSERT_TRUE(sendFrame(sequence));
+    }
+
+    // Not stale, but older than everything in the full buffer
+    TEST_ASSERT_FALSE(sendFrame(2));
+
+    run(10);
+    TEST_ASSERT_EQUAL(8, played.size());
+    TEST_ASSERT_EQUAL(3, played.front());
+    TEST_ASSERT_EQUAL(10, played.back());
+}
+
+void test_prebuffer_waits_for_a_second_packet() {
+    sendFrame(1);
+    service->update();
+    advanceMillis(FRAME_MS / 2);
+    service->update();
+    TEST_ASSERT_EQUAL(0, played.size());
+
+    // A second packet starts playback
+    sendFrame(2);
+    service->update();
+    TEST_ASSERT_EQUAL(1, played.size());
+}
+
+void test_prebuffer_gives_up_waiting() {
+    sendFrame(1);
+    run(1);
+    TEST_ASSERT_EQUAL(0, played.size());
+
+    // A lone packet plays after two intervals
+    run(1);
+    TEST_ASSERT_EQUAL(1, played.size());
+}
+
+void test_text_effect_holds_playback() {
+    uint8_t text[] = {static_cast<uint8_t>(RemoteDisplayService::Effect::WAVE), 'h', 'i'};
+    send(RemoteDisplayService::PacketType::TEXT, 1, text, sizeof(text));
+    sendFrame(2);
+    run(1);
+    TEST_ASSERT_EQUAL_STRING("wave", globalAnimator.effect.c_str());
+    TEST_ASSERT_EQUAL_STRING("hi", globalAnimator.text.c_str());
+
+    run(3);
+    TEST_ASSERT_EQUAL(0, played.size());
+
+    globalAnimator.stop();
+    run(1);
+    TEST_ASSERT_EQUAL(1, played.size());
+}
+
+void test_end_packet_hands_the_display_back() {
+    sendFrame(1);
+    send(RemoteDisplayService::PacketType::END, 2, nullptr, 0);
+    run(2);
+
+    TEST_ASSERT_FALSE(service->isActive());
+    TEST_ASSERT_EQUAL(1, clears);
+    TEST_ASSERT_EQUAL(2, activeChanges.size());
+    TEST_ASSERT_TRUE(activeChanges[0]);
+    TEST_ASSERT_FALSE(activeChanges[1]);
+
+    // The next packet starts a new stream, whatever its number
+    TEST_ASSERT_TRUE(sendFrame(1));
+    TEST_ASSERT_TRUE(service->isActive());
+}
+
+void test_idle_stream_ends() {
+    sendFrame(1);
+    sendFrame(2);
+    run(2);
+    TEST_ASSERT_TRUE(service->isActive());
+
+    advanceMillis(IDLE_MS);
+    service->update();
+    TEST_ASSERT_FALSE(service->isActive());
+    TEST_ASSERT_EQUAL(1, clears);
+}
+
+void test_invalid_packets_are_rejected() {
+    uint8_t shortFrame[VFD_FRAME_LEN - 1] = {};
+    TEST_ASSERT_FALSE(send(RemoteDisplayService::PacketType::FRAME, 1, shortFrame, sizeof(shortFrame)));
+
+    uint8_t badEffect[] = {static_cast<uint8_t>(RemoteDisplayService::Effect::COUNT), 'x'};
+    TEST_ASSERT_FALSE(send(RemoteDisplayService::PacketType::TEXT, 1, badEffect, sizeof(badEffect)));
+
+    uint8_t wrongMagic[RemoteDisplayService::HEADER_SIZE] = {'X', 'F', RemoteDisplayService::PROTOCOL_VERSION, 2, 0, 1};
+    TEST_ASSERT_FALSE(service->receive(wrongMagic, sizeof(wrongMagic)));
+
+    TEST_ASSERT_FALSE(service->isActive());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_play_in_sequence_order);
+    RUN_TEST(test_one_frame_per_interval);
+    RUN_TEST(test_stale_packets_are_dropped);
+    RUN_TEST(test_sequence_wraps_around);
+    RUN_TEST(test_overflow_skips_the_oldest);
+    RUN_TEST(test_prebuffer_waits_for_a_second_packet);
+    RUN_TEST(test_prebuffer_gives_up_waiting);
+    RUN_TEST(test_text_effect_holds_playback);
+    RUN_TEST(test_end_packet_hands_the_display_back);
+    RUN_TEST(test_idle_stream_ends);
+    RUN_TEST(test_invalid_packets_are_rejected);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// test_states/test_main.cpp
+//
+// StateManager's transition table and history, and a transition latency
+// benchmark. Switching states must not touch the heap.
+#include <unity.h>
+#include <Arduino.h>
+#include <AllocationCounter.h>
+#include <chrono>
+#include "app/states/StateManager.h"
+
+// The native env does not build src/, the units under test come along
+#include "app/states/StateManager.cpp"
+#include "services/WarmState.cpp"
+
+static const int BENCHMARK_SWITCHES = 100000;
+
+class TestState : public State {
+public:
+    TestState(StateType type, const char* name) : State(nullptr), type(type), name(name) {}
+
+    void onEnter() override { enters++; }
+    void onExit() override { exits++; }
+    void onUpdate() override {}
+    void onButtonEvent(ButtonEvent) override {}
+    StateType getType() const override { return type; }
+    const char* getName() const override { return name; }
+
+    int enters = 0;
+    int exits = 0;
+
+private:
+    StateType type;
+    const char* name;
+};
+
+static const char* const STATE_NAMES[] = {"Time", "Menu", "Scroll", "AI", "Config", "NoTime"};
+
+static std::unique_ptr<StateManager> manager;
+
+static TestState* state(StateType type) {
+    return static_cast<TestState*>(manager->getState(type));
+}
+
+void setUp() {
+    manager.reset(new StateManager(nullptr));
+    for (uint8_t i = 0; i < StateManager::STATE_COUNT; i++) {
+        StateType type = static_cast<StateType>(i);
+        manager->registerState(type, std::unique_ptr<State>(new TestState(type, STATE_NAMES[i])));
+    }
+    manager->changeState(StateType::TIME);
+}
+
+void tearDown() {
+    manager.reset();
+}
+
+void test_table_is_checked() {
+    TEST_ASSERT_TRUE(StateManager::canTransition(StateType::TIME, StateType::MENU));
+    TEST_ASSERT_TRUE(StateManager::canTransition(StateType::CONFIG, StateType::CONFIG));
+    TEST_ASSERT_FALSE(StateManager::canTransition(StateType::CONFIG, StateType::MENU));
+    TEST_ASSERT_FALSE(StateManager::canTransition(StateType::TEXT_SCROLL, StateType::AI_CHAT));
+}
+
+void test_change_follows_table() {
+    manager->changeState(StateType::CONFIG);
+    TEST_ASSERT_EQUAL(static_cast<int>(StateType::CONFIG), static_cast<int>(manager->getCurrentStateType()));
+
+    // Not in the table: nothing is exited or entered
+    manager->changeState(StateType::MENU);
+    TEST_ASSERT_EQUAL(static_cast<int>(StateType::CONFIG), static_cast<int>(manager->getCurrentStateType()));
+    TEST_ASSERT_EQUAL(0, state(StateType::MENU)->enters);
+    TEST_ASSERT_EQUAL(0, state(StateType::CONFIG)->exits);
+
+    manager->changeState(StateType::TIME);
+    TEST_ASSERT_EQUAL(2, state(StateType::TIME)->enters);
+    TEST_ASSERT_EQUAL(1, state(StateType::CONFIG)->exits);
+}
+
+void test_pop_returns_through_history() {
+    manager->pushState(StateType::MENU);
+    manager->pushState(StateType::TEXT_SCROLL);
+    manager->popState();
+    TEST_ASSERT_EQUAL(static_cast<int>(StateType::MENU), static_cast<int>(manager->getCurrentStateType()));
+    manager->popState();
+    TEST_ASSERT_EQUAL(static_cast<int>(StateType::TIME), static_cast<int>(manager->getCurrentStateType()));
+
+    // Empty history
+    manager->popState();
+    TEST_ASSERT_EQUAL(static_cast<int>(StateType::TIME), static_cast<int>(manager->getCurrentStateType()));
+}
+
+void test_full_history_drops_oldest() {
+    // TIME, MENU, TIME, MENU, TIME go into the history; the first TIME
+    // falls out
+    for (int i = 0; i < StateManager::HISTORY_DEPTH + 1; i++) {
+        manager->pushState(i % 2 ? StateType::TIME : StateType::MENU);
+    }
+    for (int i = 0; i < StateManager::HISTORY_DEPTH; i++) {
+        manager->popState();
+    }
+    TEST_ASSERT_EQUAL(static_cast<int>(StateType::MENU), static_cast<int>(manager->getCurrentStateType()));
+}
+
+void test_change_clears_history() {
+    manager->pushState(StateType::MENU);
+    manager->changeState(StateType::TIME);
+    manager->popState();
+    TEST_ASSERT_EQUAL(static_cast<int>(StateType::TIME), static_cast<int>(manager->getCurrentStateType()));
+    TEST_ASSERT_EQUAL(1, state(StateType::MENU)->enters);
+}
+
+void test_transition_latency() {
+    size_t allocationsBefore = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_SWITCHES; i++) {
+        manager->changeState(i % 2 ? StateType::TIME : StateType::MENU);
+        manager->getState(StateType::MENU);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    char report[96];
+    snprintf(report, sizeof(report), "changeState + getState: %.1f ns per switch (host)",
+             std::chrono::duration<double, std::nano>(elapsed).count() / BENCHMARK_SWITCHES);
+    TEST_MESSAGE(report);
+
+    TEST_ASSERT_EQUAL(BENCHMARK_SWITCHES / 2, state(StateType::MENU)->enters);
+    TEST_ASSERT_EQUAL(0, allocations - allocationsBefore);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_table_is_checked);
+    RUN_TEST(test_change_follows_table);
+    RUN_TEST(test_pop_returns_through_history);
+    RUN_TEST(test_full_history_drops_oldest);
+    RUN_TEST(test_change_clears_history);
+    RUN_TEST(test_transition_latency);
+    return UNITY_END();
+}
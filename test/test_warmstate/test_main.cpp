@@ -0,0 +1,109 @@
+// test_warmstate/test_main.cpp
+//
+// WarmState across simulated soft resets: the RTC memory of test/native
+// keeps its contents until a simulated power loss, a reset is a new
+// restore() of the block the previous run left.
+#include <unity.h>
+#include <Arduino.h>
+#include <sys/time.h>
+#include "services/WarmState.h"
+
+// The native env does not build src/, the unit under test comes along
+#include "services/WarmState.cpp"
+
+// WarmState keeps the block behind the 128 bytes OTA uses
+static const size_t OTA_AREA = 128;
+
+void setUp() {
+    ESP.simulatePowerLoss();
+}
+
+void tearDown() {
+}
+
+void test_power_on_is_cold() {
+    TEST_ASSERT_FALSE(WarmState::restore());
+    TEST_ASSERT_FALSE(WarmState::isWarm());
+    TEST_ASSERT_EQUAL_UINT32(0, WarmState::previous().epoch);
+    TEST_ASSERT_EQUAL_UINT8(0, WarmState::previous().stateType);
+    TEST_ASSERT_EQUAL_UINT8(255, WarmState::previous().pendingMenuIndex);
+}
+
+void test_soft_reset_restores_state() {
+    WarmState::restore();
+    WarmState::setStateType(1);
+    WarmState::setMenuSelection(4, 2);
+
+    // Reset
+    TEST_ASSERT_TRUE(WarmState::restore());
+    TEST_ASSERT_EQUAL_UINT8(1, WarmState::previous().stateType);
+    TEST_ASSERT_EQUAL_UINT8(4, WarmState::previous().menuIndex);
+    TEST_ASSERT_EQUAL_UINT8(2, WarmState::previous().pendingMenuIndex);
+}
+
+void test_state_carries_over_until_updated() {
+    WarmState::restore();
+    WarmState::setMenuSelection(3, 255);
+
+    // Two resets without any update in between
+    WarmState::restore();
+    WarmState::setStateType(2);
+    TEST_ASSERT_TRUE(WarmState::restore());
+    TEST_ASSERT_EQUAL_UINT8(2, WarmState::previous().stateType);
+    TEST_ASSERT_EQUAL_UINT8(3, WarmState::previous().menuIndex);
+}
+
+void test_time_is_captured() {
+    WarmState::restore();
+    timeval now;
+    gettimeofday(&now, nullptr);
+    WarmState::captureTime();
+
+    TEST_ASSERT_TRUE(WarmState::restore());
+    uint32_t epoch = WarmState::previous().epoch;
+    TEST_ASSERT_TRUE(epoch >= (uint32_t)now.tv_sec && epoch <= (uint32_t)now.tv_sec + 1);
+    TEST_ASSERT_LESS_THAN(1000, WarmState::previous().epochMillis);
+}
+
+void test_corrupt_block_is_cold() {
+    WarmState::restore();
+    WarmState::setMenuSelection(5, 1);
+
+    // One flipped bit in the data
+    ESP.rtcUserMemory()[OTA_AREA + 4 + 6] ^= 0x10;
+    TEST_ASSERT_FALSE(WarmState::restore());
+    TEST_ASSERT_EQUAL_UINT8(0, WarmState::previous().menuIndex);
+    TEST_ASSERT_EQUAL_UINT8(255, WarmState::previous().pendingMenuIndex);
+}
+
+void test_unchanged_values_are_not_written() {
+    WarmState::restore();
+    WarmState::setStateType(1);
+    uint32_t writes = ESP.rtcWriteCount();
+    WarmState::setStateType(1);
+    WarmState::setMenuSelection(WarmState::previous().menuIndex, WarmState::previous().pendingMenuIndex);
+    TEST_ASSERT_EQUAL_UINT32(writes, ESP.rtcWriteCount());
+}
+
+void test_ota_area_is_left_alone() {
+    uint8_t before[OTA_AREA];
+    memcpy(before, ESP.rtcUserMemory(), OTA_AREA);
+
+    WarmState::restore();
+    WarmState::setStateType(3);
+    WarmState::setMenuSelection(7, 7);
+    WarmState::captureTime();
+    TEST_ASSERT_EQUAL_MEMORY(before, ESP.rtcUserMemory(), OTA_AREA);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_power_on_is_cold);
+    RUN_TEST(test_soft_reset_restores_state);
+    RUN_TEST(test_state_carries_over_until_updated);
+    RUN_TEST(test_time_is_captured);
+    RUN_TEST(test_corrupt_block_is_cold);
+    RUN_TEST(test_unchanged_values_are_not_written);
+    RUN_TEST(test_ota_area_is_left_alone);
+    return UNITY_END();
+}